@@ -12,6 +12,52 @@ struct ScaleParam {
     int dest_height;
     float ratio_w;
     float ratio_h;
+    // 检测输入的画布尺寸, 缩放后的图像位于画布左上角; 未启用尺寸分桶时与 dest 一致
+    int canvas_width;
+    int canvas_height;
+};
+
+// 文本框得分的计算方式
+enum class BoxScoreMode {
+    kPolygon,  // 轮廓多边形内的均值
+    kIntegral, // 积分图求外接矩形内的均值, 速度快, 适合水平文本
+};
+
+// 文本框的提取方式
+enum class BoxExtractMode {
+    kContour,   // cv::findContours 提取轮廓
+    kComponent, // 基于行程的连通域标记 (行程合并与按标号汇总两遍), 同时统计外接矩形、面积与得分
+};
+
+// 调用方给定区域时的处理方式
+enum class RoiMode {
+    kSkipDetection, // 区域即文本框, 跳过检测直接裁剪、分类、识别
+    kDetectInside,  // 只在各区域的外接矩形内检测
+};
+
+// 调用方传入的 cv::Mat 的通道顺序
+enum class ColorOrder {
+    kRgb, // 默认, 与早期版本的 Process(cv::Mat) 一致
+    kBgr, // cv::imread 的输出, 省去一次整图的通道转换
+};
+
+// 内存中的模型数据, 由调用方持有, 需比加载它的网络存活更久
+struct ModelBuffer {
+    const void *data;
+    size_t length;
+};
+
+// 二值图中的一个连通域 (8 邻接)
+struct TextComponent {
+    cv::Rect rect;
+    // 前景像素数
+    int area;
+    // 每行最左与最右像素之间 (含其间的空洞) 概率图的和及像素数, score_sum / span_area 即得分,
+    // 与轮廓模式下求轮廓多边形内均值的口径一致
+    double score_sum;
+    int span_area;
+    // 每行最左、最右的像素, 凸包与连通域一致, 用于求最小外接矩形
+    std::vector<cv::Point> points;
 };
 
 struct TextBox {
@@ -47,6 +93,20 @@ struct TextBlock {
     double block_time;
 };
 
+struct DetResult {
+    // 原图坐标下的文本框
+    std::vector<TextBox> boxes;
+    double det_time;
+};
+
+// 各阶段预热耗时, 单位与其他耗时一致
+struct WarmupResult {
+    double det_time;
+    double cls_time;
+    double rec_time;
+    double full_time;
+};
+
 struct OcrResult {
     std::vector<TextBlock> blocks;
     cv::Mat box_image;
@@ -54,6 +114,9 @@ struct OcrResult {
 
     std::string str_result;
     double full_time;
+
+    // 流水线模式下该任务处理失败时的错误信息, 为空表示成功
+    std::string error;
 };
 
 } // namespace base
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+namespace base {
+
+// 非持有的连续内存视图, 用于直接读取推理输出而不拷贝, 调用方需保证底层内存在使用期间有效
+template <typename T>
+class Span {
+public:
+    Span() : data_(nullptr), size_(0) {}
+    Span(T *data, size_t size) : data_(data), size_(size) {}
+
+    T *data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T &operator[](size_t index) const { return data_[index]; }
+    T *begin() const { return data_; }
+    T *end() const { return data_ + size_; }
+
+    Span subspan(size_t offset, size_t count) const { return Span(data_ + offset, count); }
+
+private:
+    T *data_;
+    size_t size_;
+};
+
+} // namespace base
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "base/ocr_structs.h"
+#include "base/span.h"
+#include "utils/object_pool.h"
+#include "utils/session_pool.h"
+#include "utils/tensor_buffer.h"
 
 #include <onnxruntime_cxx_api.h>
 #include <opencv4/opencv2/opencv.hpp>
@@ -16,23 +20,56 @@ public:
     ~AngleNet();
 
     void Init(const std::string &model_path);
+    // 从内存加载模型, model 需比网络存活更久; 何时复制模型数据见 utils::SessionPool::Init
+    void Init(const base::ModelBuffer &model);
     void SetNumThreads(int num_threads);
+    // 使用外部共享的 Env, 需在 Init 前调用; use_global_thread_pool 为 true 时禁用会话独立线程池
+    void SetEnv(const std::shared_ptr<Ort::Env> &env, bool use_global_thread_pool);
+    // 见 DbNet::SetNumSessions
+    void SetNumSessions(int num_sessions);
+    // 预打包权重容器, 见 utils::SessionPool::SetPrepackedWeights; 需在 Init 前调用
+    void SetPrepackedWeights(const std::shared_ptr<Ort::PrepackedWeightsContainer> &prepacked_weights);
+    // 优化后模型的缓存目录, 见 utils::SessionPool::SetCacheDir; 需在 Init 前调用
+    void SetModelCacheDir(const std::string &model_cache_dir);
+    // batch_size <= 1 时逐张分类, 否则每 batch_size 张拼成一个张量推理
+    void SetBatchSize(int batch_size);
 
+    // 以空白图像在每个 Session 上按单张与 batch_size 各推理一次
+    void Warmup();
+
+    // 可被多个线程同时调用, 每次调用从池中借用独立的缓冲区与 IoBinding; Init 与 Set* 需在此之前完成
     std::vector<base::Angle> GetAngles(const std::vector<cv::Mat> &images, const std::string &path, const std::string &image_name, bool cal_angle, bool cal_most_angle);
 
 private:
-    base::Angle run(const cv::Mat &image);
-    base::Angle ScoreToAngle(const std::vector<float> &output_values);
+    // 单次推理的可变状态
+    struct Context {
+        std::shared_ptr<Ort::Session> session;
+        std::unique_ptr<Ort::IoBinding> binding;
+        utils::TensorBuffer input_buffer;
+        utils::TensorBuffer output_buffer;
+    };
+
+    std::unique_ptr<Context> CreateContext();
+    // Session 加载后读取输入输出信息, 重建 Context 池
+    void InitContexts();
+    void runBatch(Context &context, const std::vector<cv::Mat> &images, int begin, int end, std::vector<base::Angle> &angles);
+    base::Angle ScoreToAngle(base::Span<const float> output_values);
 
     bool is_output_debug_image_;
     int num_threads_;
+    int batch_size_;
 
-    std::shared_ptr<Ort::Session> session_;
-    Ort::Env env_;
+    utils::SessionPool sessions_;
+    std::shared_ptr<Ort::Env> env_;
     Ort::SessionOptions session_options_;
+    GraphOptimizationLevel optimization_level_;
+    std::string model_cache_dir_;
 
     std::string input_name_;
     std::string output_name_;
+    int64_t num_classes_;
+
+    utils::ObjectPool<Context> contexts_;
 
     const std::vector<float> mean_{127.5, 127.5, 127.5};
     const std::vector<float> norm_{1.0 / 127.5, 1.0 / 127.5, 1.0 / 127.5};
@@ -1,11 +1,17 @@
 #pragma once
 
 #include "base/ocr_structs.h"
+#include "base/span.h"
+#include "utils/object_pool.h"
+#include "utils/session_pool.h"
+#include "utils/tensor_buffer.h"
 
 #include <onnxruntime_cxx_api.h>
 #include <opencv4/opencv2/opencv.hpp>
 
+#include <map>
 #include <memory>
+#include <vector>
 
 namespace model {
 
@@ -15,23 +21,77 @@ public:
     ~CrnnNet();
 
     void Init(const std::string &model_path, const std::string &keys_path);
+    // 从内存加载模型, model 需比网络存活更久; 何时复制模型数据见 utils::SessionPool::Init
+    void Init(const base::ModelBuffer &model, const std::string &keys_path);
     void SetNumThreads(int num_threads);
+    // 使用外部共享的 Env, 需在 Init 前调用; use_global_thread_pool 为 true 时禁用会话独立线程池
+    void SetEnv(const std::shared_ptr<Ort::Env> &env, bool use_global_thread_pool);
+    // 见 DbNet::SetNumSessions
+    void SetNumSessions(int num_sessions);
+    // 预打包权重容器, 见 utils::SessionPool::SetPrepackedWeights; 需在 Init 前调用
+    void SetPrepackedWeights(const std::shared_ptr<Ort::PrepackedWeightsContainer> &prepacked_weights);
+    // 优化后模型的缓存目录, 见 utils::SessionPool::SetCacheDir; 需在 Init 前调用
+    void SetModelCacheDir(const std::string &model_cache_dir);
+    // batch_size <= 1 时逐张识别, 否则按宽度分桶后批量识别
+    void SetBatchSize(int batch_size);
+    // 宽度分桶, 需为升序; 超过最大桶宽的图像按 32 对齐单独成桶
+    void SetWidthBuckets(const std::vector<int> &width_buckets);
+    // 逐张识别时输入宽度的对齐单位, 多出的列以均值填充, 默认为 1 即按缩放后的宽度推理, 与批量关闭时的原有输入一致.
+    // 大于 1 时推理形状与输出时间步数只随对齐后的宽度变化, 时间步数的缓存更易命中, Warmup 对逐张识别也有效,
+    // 但填充会改变模型输入, 识别结果与得分可能略有不同
+    void SetWidthAlign(int width_align);
+    // 关闭后不计算每个字符的 softmax 得分, char_scores 为空
+    void SetCalCharScores(bool cal_char_scores);
 
+    // 以空白图像在每个 Session 上按各缩放后宽度 (按 SetWidthAlign 对齐) 推理一次, 批量模式下按对应的桶宽以单张与 batch_size
+    // 各推理一次, 同时记录各宽度的输出时间步数. widths 为空时取宽度分桶
+    void Warmup(const std::vector<int> &widths);
+
+    // 可被多个线程同时调用, 每次调用从池中借用独立的缓冲区与 IoBinding; Init 与 Set* 需在此之前完成
     std::vector<base::TextLine> GetTextLines(const std::vector<cv::Mat> &images, const std::string &path, const std::string &image_name);
 
 private:
-    base::TextLine run(const cv::Mat &src);
-    base::TextLine ScoreToTextLine(const std::vector<float> &output_values, int h, int w);
+    // 单次推理的可变状态
+    struct Context {
+        std::shared_ptr<Ort::Session> session;
+        std::unique_ptr<Ort::IoBinding> binding;
+        utils::TensorBuffer input_buffer;
+        utils::TensorBuffer output_buffer;
+        std::vector<int> batch_indexes;
+        // 输出时间步数由输入宽度决定, 首次遇到某一宽度时由 ORT 分配输出并记录, 之后预分配.
+        // 逐张识别且不对齐时以实际宽度为键, 项数不超过出现过的不同宽度数, 每项只占几十字节
+        std::map<int, int64_t> time_steps;
+        int64_t num_classes;
+    };
+
+    std::unique_ptr<Context> CreateContext();
+    // Session 加载后读取输入输出信息, 重建 Context 池
+    void InitContexts();
+    void LoadKeys(const std::string &keys_path);
+    void runBatch(Context &context, const std::vector<cv::Mat> &images, const std::vector<int> &indexes, int bucket_width, std::vector<base::TextLine> &text_lines);
+    int GetBucketWidth(int width) const;
+    // output 从第一个时间步开始, 相邻时间步间隔 step_stride 个元素
+    base::TextLine ScoreToTextLine(base::Span<const float> output, int steps, int num_classes, int step_stride);
 
     bool is_output_debug_image_;
     int num_threads_;
+    int batch_size_;
+    bool is_cal_char_scores_;
+    std::vector<int> width_buckets_;
+    int width_align_;
 
-    std::shared_ptr<Ort::Session> session_;
-    Ort::Env env_;
+    utils::SessionPool sessions_;
+    std::shared_ptr<Ort::Env> env_;
     Ort::SessionOptions session_options_;
+    GraphOptimizationLevel optimization_level_;
+    std::string model_cache_dir_;
 
     std::string input_name_;
     std::string output_name_;
+    int64_t num_classes_;
+
+    Ort::MemoryInfo memory_info_;
+    utils::ObjectPool<Context> contexts_;
 
     const std::vector<float> mean_{127.5, 127.5, 127.5};
     const std::vector<float> norm_{1.0 / 127.5, 1.0 / 127.5, 1.0 / 127.5};
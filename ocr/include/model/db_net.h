@@ -1,6 +1,9 @@
 #pragma once
 
 #include "base/ocr_structs.h"
+#include "utils/object_pool.h"
+#include "utils/session_pool.h"
+#include "utils/tensor_buffer.h"
 
 #include <onnxruntime_cxx_api.h>
 #include <opencv4/opencv2/opencv.hpp>
@@ -16,22 +19,75 @@ public:
     ~DbNet();
 
     void Init(const std::string &model_path);
+    // 从内存加载模型, model 需比网络存活更久; 何时复制模型数据见 utils::SessionPool::Init
+    void Init(const base::ModelBuffer &model);
     void SetNumThreads(int num_threads);
+    // 使用外部共享的 Env, 需在 Init 前调用; use_global_thread_pool 为 true 时禁用会话独立线程池
+    void SetEnv(const std::shared_ptr<Ort::Env> &env, bool use_global_thread_pool);
+    // 加载 num_sessions 个 Session, 每次调用独占其中一个, 同时进行的检测数不超过 num_sessions;
+    // 为 0 时所有调用共享一个 Session 且不限并发. 多于一个时 SetNumThreads 的线程数 (未设置时为核数) 平均分给各 Session,
+    // 使用全局线程池时各 Session 共用该线程池, 不再划分. 需在 Init 前调用
+    void SetNumSessions(int num_sessions);
+    // 预打包权重容器, 见 utils::SessionPool::SetPrepackedWeights; 需在 Init 前调用
+    void SetPrepackedWeights(const std::shared_ptr<Ort::PrepackedWeightsContainer> &prepacked_weights);
+    // 优化后模型的缓存目录, 见 utils::SessionPool::SetCacheDir; 需在 Init 前调用
+    void SetModelCacheDir(const std::string &model_cache_dir);
+    void SetBoxScoreMode(base::BoxScoreMode box_score_mode);
+    // 连通域模式下得分取每行最左到最右像素之间的均值 (空洞与凹处的低分像素同样计入), 对近似凸的文本区域与
+    // 轮廓模式的多边形均值一致, box_score_threshold 的含义不变; 不受 SetBoxScoreMode 影响
+    void SetBoxExtractMode(base::BoxExtractMode box_extract_mode);
+    // 检测输入尺寸分桶: 缩放后的图像放入能容纳它的最小画布, 其余区域以白色填充, 使推理形状固定在少数几种,
+    // 便于 ORT 复用内存规划. 没有能容纳的画布时使用原尺寸. Init 时会对每种画布预先推理一次
+    void SetShapeBuckets(const std::vector<cv::Size> &shape_buckets);
 
+    // 以全零输入在每个 Session 上按各检测输入尺寸 (宽高为 32 的倍数) 推理一次; 启用尺寸分桶时按对应的画布推理,
+    // sizes 为空时取全部画布
+    void Warmup(const std::vector<cv::Size> &sizes);
+
+    // 可被多个线程同时调用, 每次调用从池中借用独立的缓冲区与 IoBinding; Init 与 Set* 需在此之前完成
     std::vector<base::TextBox> GetTextBoxes(cv::Mat &src, base::ScaleParam &scale_param, float box_score_threshold, float box_threshold, float unclip_ratio);
 
 private:
-    std::vector<base::TextBox> FindRsBoxes(const cv::Mat &feat, const cv::Mat &binary_feat, base::ScaleParam &scale_param, float box_score_threshold, float unclip_ratio);
+    // 单次推理的可变状态: 输入输出缓冲区由 Context 持有并复用, 通过 IoBinding 绑定到会话
+    struct Context {
+        std::shared_ptr<Ort::Session> session;
+        std::unique_ptr<Ort::IoBinding> binding;
+        utils::TensorBuffer input_buffer;
+        utils::TensorBuffer output_buffer;
+        // 二值图与每行前景的列范围, 由阈值化一次生成
+        cv::Mat binary_feat;
+        std::vector<cv::Range> row_ranges;
+        std::vector<base::TextComponent> components;
+        cv::Mat integral_feat;
+    };
+
+    std::unique_ptr<Context> CreateContext();
+    // Session 加载后读取输入输出信息, 重建 Context 池
+    void InitContexts();
+    // 选择画布尺寸, 写入 scale_param 的 canvas 字段
+    void SelectCanvas(base::ScaleParam &scale_param) const;
+    void WarmupShape(Context &context, int width, int height);
+    // 对每个 Session 的每种画布各推理一次
+    void WarmupShapes(const std::vector<cv::Size> &shapes);
+
+    std::vector<base::TextBox> FindRsBoxes(Context &context, const cv::Mat &feat, base::ScaleParam &scale_param, float box_score_threshold, float unclip_ratio);
 
     int num_threads_;
+    base::BoxScoreMode box_score_mode_;
+    base::BoxExtractMode box_extract_mode_;
+    std::vector<cv::Size> shape_buckets_;
 
-    std::shared_ptr<Ort::Session> session_;
-    Ort::Env env_;
+    utils::SessionPool sessions_;
+    std::shared_ptr<Ort::Env> env_;
     Ort::SessionOptions session_options_;
+    GraphOptimizationLevel optimization_level_;
+    std::string model_cache_dir_;
 
     std::string input_name_;
     std::string output_name_;
 
+    utils::ObjectPool<Context> contexts_;
+
     const std::vector<float> mean_{0.485 * 255, 0.456 * 255, 0.406 * 255};
     const std::vector<float> norm_{1.0 / 0.229 / 255.0, 1.0 / 0.224 / 255.0, 1.0 / 0.225 / 255.0};
 };
@@ -4,22 +4,43 @@
 #include "model/angle_net.h"
 #include "model/db_net.h"
 #include "model/crnn_net.h"
+#include "utils/blocking_queue.h"
+#include "utils/file_utils.h"
 
 #include <opencv4/opencv2/opencv.hpp>
 #include <onnxruntime_cxx_api.h>
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace model {
 
+// 线程安全: 完成 Set* 与 Init 后, Process / DetectBoxes / RecognizeLines 可被多个线程同时调用.
+// 会话、字典等只读状态共享, 每次调用的缓冲区与 IoBinding 从各网络的池中借用, 并发数即池中的对象数;
+// 设置了 Session 数的阶段, 每次调用独占一个 Session, 超出的调用等待归还.
+// 输出开关可随时修改; 其余 Set* 与 Init、流水线的启停不可与处理并发
 class OcrLite {
 public:
     OcrLite() : is_output_console_(false),
                 is_output_part_image_(false),
                 is_output_result_text_(false),
                 is_output_result_image_(false),
-                output_path_("./") {}
-    ~OcrLite() = default;
+                output_path_("./"),
+                use_global_thread_pool_(false),
+                global_intra_op_threads_(0),
+                global_inter_op_threads_(1),
+                allow_spinning_(false),
+                map_models_(false),
+                input_color_order_(base::ColorOrder::kRgb),
+                det_tile_size_(0),
+                det_tile_overlap_(64),
+                next_task_id_(0),
+                is_pipeline_running_(false) {}
+    ~OcrLite() { StopPipeline(); }
 
     void SetOutputConsole(bool is_output_console) { is_output_console_ = is_output_console; }
     void SetOutputPartImage(bool is_output_part_image) { is_output_part_image_ = is_output_part_image; }
@@ -27,31 +48,182 @@ public:
     void SetOutputResultImage(bool is_output_result_image) { is_output_result_image_ = is_output_result_image; }
 
     void SetOutputPath(const std::string &output_path) { output_path_ = output_path; }
+    // 以 cv::Mat 传入的图像 (Process / Submit / DetectBoxes / RecognizeLines) 的通道顺序, 默认 RGB.
+    // 内部统一按 BGR 处理, RGB 输入在进入时转换一次; 输出的结果图像始终为 BGR. 按路径读取的图像不受影响
+    void SetInputColorOrder(base::ColorOrder color_order) { input_color_order_ = color_order; }
 
     void Init(const std::string &det_path, const std::string &cls_path, const std::string &rec_path, const std::string &keys_path);
+    // 从内存加载模型, 各 buffer 需比 OcrLite 存活更久
+    void Init(const base::ModelBuffer &det_model, const base::ModelBuffer &cls_model, const base::ModelBuffer &rec_model, const std::string &keys_path);
+    // 按路径 Init 时以只读内存映射加载模型文件, 映射失败时退回按路径加载. 仅对 ORT 格式的模型有意义: 常量权重直接引用
+    // 映射的页, 多个进程加载同一模型时共用这部分物理内存; ONNX 格式的模型仍会解析并复制到各进程的堆上, 与按路径加载无异.
+    // 同时设置 SetModelCacheDir 时, 缓存为 ORT 格式, 命中后映射的是缓存文件, 因此 ONNX 模型经缓存后同样受益. 需在 Init 前调用
+    void SetMapModels(bool map_models) { map_models_ = map_models; }
+    // 三个模型的全部 Session 共用的预打包权重容器, 同一容器可传给多个 OcrLite 实例. 需在 Init 前调用
+    void SetPrepackedWeights(const std::shared_ptr<Ort::PrepackedWeightsContainer> &prepacked_weights);
+    // 优化后模型的缓存目录, 三个模型共用; 首次启动时写入, 之后直接加载并跳过图优化. 需在 Init 前调用
+    void SetModelCacheDir(const std::string &model_cache_dir);
+    // 每个阶段的 intra-op 总线程数; 该阶段有多个 Session 时由 SessionPool 平均分配, 见 SetNumSessions
     void SetNumThreads(int num_threads);
+    // 三个模型共享同一个 Env 的全局线程池, 需在 Init 前调用; intra_op_threads 为 0 时使用全部核
+    // ORT 的 Env 是进程级单例, 同一进程内以首个创建的 Env 配置为准
+    void SetGlobalThreadPool(int intra_op_threads, int inter_op_threads = 1, bool allow_spinning = false);
+    // 各阶段加载的 Session 数, 即该阶段同时推理的上限; 为 0 时共享一个 Session 且不限并发.
+    // 多于一个时 SetNumThreads 的线程数在该阶段的各 Session 间平均分配, 不会因 K 个 Session 同时推理而超额占用核;
+    // 设置 SetGlobalThreadPool 时所有 Session 共用全局线程池. 需在 Init 前调用
+    void SetNumSessions(int det_sessions, int cls_sessions, int rec_sessions);
+    void SetClsBatchSize(int batch_size);
+    void SetRecBatchSize(int batch_size);
+    void SetRecWidthBuckets(const std::vector<int> &width_buckets);
+    // 见 CrnnNet::SetWidthAlign
+    void SetRecWidthAlign(int width_align);
+    void SetCalCharScores(bool cal_char_scores);
+    void SetBoxScoreMode(base::BoxScoreMode box_score_mode);
+    void SetBoxExtractMode(base::BoxExtractMode box_extract_mode);
+    // 分块检测: 检测输入的长边超过 tile_size 时, 按 tile_size x tile_size (检测输入像素) 分块逐块检测,
+    // 相邻分块重叠 tile_overlap, 再合并接缝处的文本框. 显存/内存峰值只取决于分块大小, tile_size 为 0 时关闭
+    void SetDetTiling(int tile_size, int tile_overlap = 64);
+    // 检测输入尺寸分桶, 见 DbNet::SetShapeBuckets; 在 Init 前调用可在加载时完成预热
+    void SetDetShapeBuckets(const std::vector<cv::Size> &shape_buckets);
+
+    // 以合成输入依次预热检测、角度分类与识别, 使首次处理不再承担内存分配与算子选择的开销, 返回各阶段耗时.
+    // det_sizes 为检测输入尺寸 (宽高为 32 的倍数), 为空时取尺寸分桶; rec_widths 为文本行缩放到 32 高后的宽度,
+    // 为空时取宽度分桶. 设置了多个 Session 时每个 Session 都会预热. 需在 Init 与其余 Set* 之后调用
+    base::WarmupResult Warmup(const std::vector<cv::Size> &det_sizes = {}, const std::vector<int> &rec_widths = {});
+    // 未设置尺寸分桶时 Warmup 的检测尺寸: 按 Process 的填充与 GetScaleParam 缩放, 由代表性的原图尺寸
+    // image_sizes 推算检测输入尺寸, 为空时取常见的拍照、扫描与截图尺寸. 只有与代表尺寸缩放结果相同的图像
+    // 首次处理才是热的, 其余尺寸 (尤其是长边小于 max_side_len 的图像) 仍会承担首次开销; 需要保证时应使用 SetDetShapeBuckets
+    static std::vector<cv::Size> GetDetWarmupSizes(int max_side_len, int padding, const std::vector<cv::Size> &image_sizes = {});
 
     base::OcrResult Process(const std::string &image_dir, const std::string &image_name, int padding, int max_side_len, float box_score_threshold, float box_threshold, float unclip_ratio, bool cal_angle, bool cal_most_angle);
 
+    // src 的通道顺序见 SetInputColorOrder
     base::OcrResult Process(cv::Mat &src, int padding, int max_side_len, float box_score_threshold, float box_threshold, float unclip_ratio, bool cal_angle, bool cal_most_angle);
 
+    // 区域模式: regions 为原图坐标下的四边形, 顶点按左上、右上、右下、左下排列, 超出图像的部分被裁掉.
+    // kSkipDetection 时各区域直接作为文本框 (得分为 1); kDetectInside 时逐区域检测, 每个区域按 max_side_len 单独缩放
+    base::OcrResult Process(cv::Mat &src, const std::vector<std::vector<cv::Point>> &regions, base::RoiMode roi_mode, int padding, int max_side_len, float box_score_threshold, float box_threshold, float unclip_ratio, bool cal_angle, bool cal_most_angle);
+
+    // 仅检测: 返回原图坐标下的文本框与得分, 不做裁剪、角度分类与识别. 分块检测与尺寸分桶的设置同样生效
+    base::DetResult DetectBoxes(cv::Mat &src, int padding, int max_side_len, float box_score_threshold, float box_threshold, float unclip_ratio);
+
+    // 仅识别: images 为已裁剪好的单行文本图像 (通道顺序见 SetInputColorOrder), 不做填充与检测. cal_angle 为 true 时先做角度分类,
+    // 倒置的图像旋转 180 度后再识别; angles 非空时输出每行的角度结果. 分类与识别均按各自的批大小批量推理
+    std::vector<base::TextLine> RecognizeLines(const std::vector<cv::Mat> &images, bool cal_angle, bool cal_most_angle, std::vector<base::Angle> *angles = nullptr);
+
+    // 流水线模式: 检测、角度分类、文本识别各占一个线程, 通过容量为 queue_capacity 的队列衔接,
+    // 使第 N+1 张图像的检测与第 N 张图像的分类、识别重叠执行. 运行期间不可调用 Process
+    void StartPipeline(int queue_capacity = 4);
+    // 关闭输入并等待已提交的图像全部处理完毕, 之后仍可通过 Collect 取出剩余结果
+    void StopPipeline();
+
+    // 提交一张图像, 输入队列已满时阻塞, 返回任务编号. 图像无法读取或处理出错时, 该任务的结果中 error 非空.
+    // src 的通道顺序见 SetInputColorOrder; 任务不会与 src 共享像素, 提交后调用方可复用 src
+    int64_t Submit(const std::string &image_dir, const std::string &image_name, int padding, int max_side_len, float box_score_threshold, float box_threshold, float unclip_ratio, bool cal_angle, bool cal_most_angle);
+    int64_t Submit(cv::Mat &src, int padding, int max_side_len, float box_score_threshold, float box_threshold, float unclip_ratio, bool cal_angle, bool cal_most_angle);
+
+    // 按提交顺序取出结果, 无结果时阻塞; 流水线停止且结果取空后返回 false
+    // 结果队列不限容量, 调用方应及时取出结果
+    bool Collect(int64_t &task_id, base::OcrResult &result);
+
 private:
+    // 单张图像在各阶段之间传递的中间状态
+    struct OcrTask {
+        int64_t id;
+        std::string image_dir;
+        std::string image_name;
+        cv::Mat src;
+        cv::Rect original_rect;
+        base::ScaleParam scale_param;
+        // 检测时的缩放比例
+        float det_scale;
+        float box_score_threshold;
+        float box_threshold;
+        float unclip_ratio;
+        bool cal_angle;
+        bool cal_most_angle;
+        int max_side_len;
+        // 调用方给定的区域, 已换算到填充后的坐标
+        bool has_regions;
+        base::RoiMode roi_mode;
+        std::vector<std::vector<cv::Point>> regions;
+
+        // 图像无效或某一阶段抛出异常时的错误信息, 之后的阶段跳过该任务
+        std::string error;
+
+        double start_time;
+        double det_time;
+        std::vector<base::TextBox> boxes;
+        std::vector<cv::Mat> box_images;
+        std::vector<base::Angle> angles;
+        std::vector<base::TextLine> text_lines;
+    };
+    typedef std::unique_ptr<OcrTask> OcrTaskPtr;
+    typedef std::pair<int64_t, base::OcrResult> TaskResult;
+
+    // 创建三个模型共用的 Env
+    void InitEnv();
+
     cv::Mat MakePadding(cv::Mat &src, const int padding, const cv::Scalar &padding_value = {255, 255, 255});
 
     std::vector<cv::Mat> GetBoxImages(const cv::Mat &src, std::vector<base::TextBox> &boxes, const std::string &path, const std::string &image_name);
 
-    base::OcrResult process(const std::string &path, const std::string &image_name,cv::Mat &src, cv::Rect &orignal_rect, base::ScaleParam &scale_param, float box_score_threshold = 0.6f, float box_threshold = 0.3f, float unclip_ratio = 2.0f, bool cal_angle = true, bool cal_most_angle = true);
+    // color_order 为 src 的通道顺序, task->src 统一为 BGR
+    OcrTaskPtr MakeTask(const std::string &image_dir, const std::string &image_name, cv::Mat &src, base::ColorOrder color_order, int padding, int max_side_len, float box_score_threshold, float box_threshold, float unclip_ratio, bool cal_angle, bool cal_most_angle);
+
+    base::OcrResult process(OcrTask &task);
 
-    bool is_output_console_;
-    bool is_output_part_image_;
-    bool is_output_result_text_;
-    bool is_output_result_image_;
+    // 流水线各阶段
+    void Detect(OcrTask &task);
+    // 检测 src 中 rect 区域内的文本框, 返回整图坐标
+    std::vector<base::TextBox> DetectRect(const cv::Mat &src, const cv::Rect &rect, float scale, float box_score_threshold, float box_threshold, float unclip_ratio);
+    std::vector<base::TextBox> DetectTiles(OcrTask &task);
+    std::vector<base::TextBox> DetectRegions(OcrTask &task);
+    void Classify(OcrTask &task);
+    void Recognize(OcrTask &task);
+    base::OcrResult MakeResult(OcrTask &task);
+
+    // 执行一个阶段, 任务已出错时跳过, 异常记录到 task.error
+    void RunStage(OcrTask &task, void (OcrLite::*stage)(OcrTask &));
+    void DetectLoop();
+    void ClassifyLoop();
+    void RecognizeLoop();
+
+    std::atomic<bool> is_output_console_;
+    std::atomic<bool> is_output_part_image_;
+    std::atomic<bool> is_output_result_text_;
+    std::atomic<bool> is_output_result_image_;
 
     std::string output_path_; // 默认为pwd
 
+    bool use_global_thread_pool_;
+    int global_intra_op_threads_;
+    int global_inter_op_threads_;
+    bool allow_spinning_;
+    std::shared_ptr<Ort::Env> env_;
+
+    // 映射的模型文件, 需比各网络的 Session 存活更久
+    bool map_models_;
+    utils::MappedFile det_file_;
+    utils::MappedFile cls_file_;
+    utils::MappedFile rec_file_;
+
+    base::ColorOrder input_color_order_;
+
+    int det_tile_size_;
+    int det_tile_overlap_;
+
     AngleNet angle_net_;
     DbNet db_net_;
     CrnnNet crnn_net_;
+
+    std::atomic<int64_t> next_task_id_;
+    bool is_pipeline_running_;
+    std::unique_ptr<utils::BlockingQueue<OcrTaskPtr>> det_queue_;
+    std::unique_ptr<utils::BlockingQueue<OcrTaskPtr>> cls_queue_;
+    std::unique_ptr<utils::BlockingQueue<OcrTaskPtr>> rec_queue_;
+    std::unique_ptr<utils::BlockingQueue<TaskResult>> result_queue_;
+    std::vector<std::thread> pipeline_threads_;
 };
     
 } // namespace model
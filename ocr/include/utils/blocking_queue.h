@@ -0,0 +1,59 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace utils {
+
+// 线程安全的阻塞队列, capacity 为 0 时不限容量
+template <typename T>
+class BlockingQueue {
+public:
+    explicit BlockingQueue(size_t capacity = 0) : capacity_(capacity), closed_(false) {}
+
+    // 队列已满时阻塞, 队列关闭后返回 false
+    bool Push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] { return closed_ || capacity_ == 0 || queue_.size() < capacity_; });
+        if (closed_) return false;
+        queue_.push_back(std::move(item));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // 队列为空时阻塞, 队列关闭且取空后返回 false
+    bool Pop(T &item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return closed_ || !queue_.empty(); });
+        if (queue_.empty()) return false;
+        item = std::move(queue_.front());
+        queue_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    // 关闭后不再接受新元素, 已入队的元素仍可取出
+    void Close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    // 重新接受新元素, 关闭前未取出的元素保留
+    void Reopen() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = false;
+    }
+
+private:
+    size_t capacity_;
+    bool closed_;
+    std::deque<T> queue_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+};
+
+} // namespace utils
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <vector>
 #include <sys/stat.h>
@@ -26,6 +27,11 @@ public:
         return false;
     }
 
+    // 创建单级目录, 已存在时也返回 true
+    static inline bool CreateDir(const std::string &path) {
+        return mkdir(path.c_str(), 0755) == 0 || IsDirectory(path);
+    }
+
     static inline std::string GetDirName(const std::string &path) {
         size_t pos = path.find_last_of("/\\");
         if (pos == std::string::npos) {
@@ -42,5 +48,26 @@ public:
         return path.substr(pos + 1);
     }
 };
+
+// 只读映射的文件, 析构时解除映射; 多个进程映射同一文件时共享页缓存, 不重复读盘
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // 映射失败或文件为空时返回 false
+    bool Open(const std::string &path);
+    void Close();
+
+    const void *data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return data_ == nullptr; }
+
+private:
+    void *data_;
+    size_t size_;
+};
     
 } // namespace utils
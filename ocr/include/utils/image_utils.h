@@ -18,6 +18,9 @@ public:
 
     static base::ScaleParam GetScaleParam(const cv::Mat &src, float scale);
     static base::ScaleParam GetScaleParam(const cv::Mat &src, int target_max_side_len);
+    // 只依赖图像尺寸, 供未读入图像时推算检测输入尺寸
+    static base::ScaleParam GetScaleParam(const cv::Size &src_size, float scale);
+    static base::ScaleParam GetScaleParam(const cv::Size &src_size, int target_max_side_len);
 };
 
 }
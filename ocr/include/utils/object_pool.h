@@ -0,0 +1,106 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace utils {
+
+// 线程安全的对象池, 对象由 factory 按需创建; max_size 为 0 时不限数量, 否则池中对象用尽后 Acquire 阻塞
+template <typename T>
+class ObjectPool {
+public:
+    typedef std::function<std::unique_ptr<T>()> Factory;
+
+    // 借出的对象, 析构时自动归还; 对象池需比所有借出的对象存活更久
+    class Lease {
+    public:
+        Lease() : pool_(nullptr) {}
+        Lease(ObjectPool *pool, std::unique_ptr<T> object) : pool_(pool), object_(std::move(object)) {}
+        Lease(Lease &&other) : pool_(other.pool_), object_(std::move(other.object_)) { other.pool_ = nullptr; }
+        Lease &operator=(Lease &&other) {
+            if (this != &other) {
+                Return();
+                pool_ = other.pool_;
+                object_ = std::move(other.object_);
+                other.pool_ = nullptr;
+            }
+            return *this;
+        }
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+        ~Lease() { Return(); }
+
+        T *get() const { return object_.get(); }
+        T *operator->() const { return object_.get(); }
+        T &operator*() const { return *object_; }
+        explicit operator bool() const { return object_ != nullptr; }
+
+    private:
+        void Return() {
+            if (pool_ && object_) {
+                pool_->Release(std::move(object_));
+            }
+            pool_ = nullptr;
+        }
+
+        ObjectPool *pool_;
+        std::unique_ptr<T> object_;
+    };
+
+    explicit ObjectPool(Factory factory = Factory(), size_t max_size = 0)
+            : factory_(std::move(factory)), max_size_(max_size), num_created_(0) {}
+
+    // 丢弃池中空闲的对象并更换 factory, 已借出的对象归还后仍会回到池中
+    void Reset(Factory factory, size_t max_size = 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        factory_ = std::move(factory);
+        max_size_ = max_size;
+        num_created_ -= idle_.size();
+        idle_.clear();
+        available_.notify_all();
+    }
+
+    Lease Acquire() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        available_.wait(lock, [this] { return !idle_.empty() || max_size_ == 0 || num_created_ < max_size_; });
+        if (!idle_.empty()) {
+            std::unique_ptr<T> object = std::move(idle_.back());
+            idle_.pop_back();
+            return Lease(this, std::move(object));
+        }
+
+        // 创建新对象时不持有锁, 以免阻塞其他线程归还对象
+        ++num_created_;
+        Factory factory = factory_;
+        lock.unlock();
+        std::unique_ptr<T> object;
+        try {
+            object = factory();
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(mutex_);
+            --num_created_;
+            available_.notify_one();
+            throw;
+        }
+        return Lease(this, std::move(object));
+    }
+
+private:
+    void Release(std::unique_ptr<T> object) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(std::move(object));
+        available_.notify_one();
+    }
+
+    Factory factory_;
+    size_t max_size_;
+    size_t num_created_;
+    std::vector<std::unique_ptr<T>> idle_;
+    std::mutex mutex_;
+    std::condition_variable available_;
+};
+
+} // namespace utils
@@ -17,12 +17,44 @@ public:
     static void GetOutputName(std::shared_ptr<Ort::Session> session, std::string &output_name);
 
     static std::vector<float> SubstractMeanNormalize(const cv::Mat &image, const std::vector<float> &mean, const std::vector<float> &norm);
+    // 写入调用方提供的缓冲区, dest 至少需要 cols * rows * channels 个元素
+    static void SubstractMeanNormalize(const cv::Mat &image, const std::vector<float> &mean, const std::vector<float> &norm, float *dest);
+    // 预处理: 将 8UC3 图像以 cv::resize (INTER_LINEAR) 缩放至 resize_width x resize_height, 再逐行交换 R/B 通道(可选)、
+    // 减均值归一化, 直接写入 CHW 排布的张量; 后三步按 CPU 分派到 SimdUtils::NormalizeRow, 省去整图的通道转换与中间张量.
+    // 每个通道平面为 resize_height x dest_stride, 只写入前 dest_stride 列, 不足 dest_stride 的列以 pad_value (源图通道顺序的像素值) 填充
+    static void ResizeNormalize(const cv::Mat &src, int resize_width, int resize_height, int dest_stride, const std::vector<float> &mean, const std::vector<float> &norm, bool swap_rb, const cv::Scalar &pad_value, float *dest);
+    // 同上, 通道平面为 dest_rows x dest_stride, 图像位于左上角, 底部多出的行同样以 pad_value 填充
+    static void ResizeNormalize(const cv::Mat &src, int resize_width, int resize_height, int dest_stride, int dest_rows, const std::vector<float> &mean, const std::vector<float> &norm, bool swap_rb, const cv::Scalar &pad_value, float *dest);
 
     static std::vector<cv::Point> GetMinBoxes(const std::vector<cv::Point> &points, float &min_side_len, float &perimeter);
+    // 多边形内 feat 的均值, 逐行扫描求和, 不分配掩码也不拷贝区域; 多边形自交时按奇偶规则, 边上的像素计入
     static float BoxScoreFast(const cv::Mat &feat, const std::vector<cv::Point> &box);
+    // 快速模式: integral_feat 为 feat 的 CV_64F 积分图, 返回外接矩形内的均值, 适用于水平文本框
+    static float BoxScoreIntegral(const cv::Mat &integral_feat, const std::vector<cv::Point> &box);
+    // 基于行程的连通域标记: 第一遍逐行提取行程并与上一行相交的行程合并, 第二遍按标号汇总各连通域的统计信息.
+    // 顺序为首个像素的光栅顺序, 即整图 findContours 输出的外轮廓逆序后的顺序
+    // row_ranges 非空时只扫描每行的 [start, end) 列, 空区间的行直接跳过
+    static void FindComponents(const cv::Mat &binary_feat, const cv::Mat &feat, std::vector<base::TextComponent> &components, const std::vector<cv::Range> *row_ranges = nullptr);
+    // 以全空的行为界将前景划分为若干行带, 每个行带只在其列范围内查找轮廓, 跳过空白区域.
+    // 输出顺序与对整图调用 findContours (RETR_LIST) 一致
+    static void FindBandContours(const cv::Mat &binary_feat, const std::vector<cv::Range> &row_ranges, std::vector<std::vector<cv::Point>> &contours);
+
     static std::vector<cv::Point> UnClip(const std::vector<cv::Point> &box, float perimeter, float unclip_ratio);
+    // 凸四边形的解析扩张: 各边沿法向平移后求交, 不是凸四边形时返回 false
+    // 对矩形与 Clipper 圆角扩张后再取最小外接矩形的结果一致
+    static bool UnClipConvexQuad(const std::vector<cv::Point> &box, float perimeter, float unclip_ratio, std::vector<cv::Point> &out_box);
+    // 基于 ClipperOffset 的通用实现, 适用于任意多边形
+    static std::vector<cv::Point> UnClipClipper(const std::vector<cv::Point> &box, float perimeter, float unclip_ratio);
+
+    // 将 size 切分为边长 tile_size、相邻重叠 overlap 的分块, 最后一块与边缘对齐
+    static std::vector<cv::Rect> GetTileRects(const cv::Size &size, int tile_size, int overlap);
+    // 合并各分块检测到的文本框 (坐标已在整图坐标系下): 重叠区域内的重复框, 以及在分块内部边界被截断的同一行文本.
+    // 输出按外接矩形的 (上边界, 左边界) 自上而下排列
+    static std::vector<base::TextBox> MergeTileBoxes(const std::vector<std::vector<base::TextBox>> &tile_boxes, const std::vector<cv::Rect> &tile_rects, const cv::Size &size);
 
     static std::vector<int> GetAngleIndexes(const std::vector<base::Angle> &angles);
+    // 多数方向: 0 (倒置) 严格多于一半时返回 0, 否则返回 1, 票数相同时视为正向
+    static int GetMostAngleIndex(const std::vector<base::Angle> &angles);
 
     static void DrawTextBox(cv::Mat &src, const cv::RotatedRect &rect, int thickness);
     static void DrawTextBox(cv::Mat &src, const std::vector<cv::Point> &points, int thickness);
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <onnxruntime_cxx_api.h>
+
+#include "utils/file_utils.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace utils {
+
+// 同一模型的一组 Session. size 为 0 时只加载一个 Session, 由所有调用共享;
+// size 为 K 时加载 K 个 Session, 共享同一个预打包权重容器, 常量权重在内存中只保留一份
+class SessionPool {
+public:
+    SessionPool();
+    ~SessionPool();
+
+    // 需在 Init 前调用
+    void SetSize(int size);
+    int size() const { return size_; }
+    // 会话独立线程池的总线程数, 为 0 时取 CPU 核数. size 大于 1 时平均分给各 Session (每个至少 1 个),
+    // 避免 K 个 Session 同时推理时各自占满全部核. 线程数只在此处按 Session 数划分, 调用方传入总数即可, 不应再自行除以并发数;
+    // options 禁用会话独立线程池时无作用. 需在 Init 前调用
+    void SetNumThreads(int num_threads);
+    // 使用外部的预打包权重容器, 可与其他模型、其他 SessionPool 共用; 未设置时仅在 size 大于 1 时创建. 需在 Init 前调用
+    void SetPrepackedWeights(const std::shared_ptr<Ort::PrepackedWeightsContainer> &prepacked_weights);
+    // 优化后模型的缓存目录, cache_dir 为空时关闭. 缓存文件以模型内容的 FNV-1a 哈希、ORT 版本、EP、CPU 指令集与优化级别命名,
+    // 任一项变化即换用新文件, 多台机器共用缓存目录时互不干扰; 命中时直接加载 ORT 格式的缓存并跳过图优化.
+    // optimization_level 与 execution_provider 需与 options 一致
+    void SetCacheDir(const std::string &cache_dir, GraphOptimizationLevel optimization_level, const std::string &execution_provider = "cpu");
+
+    void Init(Ort::Env &env, const std::string &model_path, const Ort::SessionOptions &options);
+    // 从内存加载, model_data 需比 SessionPool 存活更久. ORT 格式的模型直接使用这段内存 (含常量权重), 不再复制;
+    // ONNX 格式的模型总会解析并复制一份, 与按路径加载相同. 启用缓存且命中时改为映射缓存文件, 不再引用 model_data
+    void Init(Ort::Env &env, const void *model_data, size_t model_data_length, const Ort::SessionOptions &options);
+
+    bool empty() const { return sessions_.empty(); }
+    // 加载的 Session 数, 共享模式下为 1
+    int count() const { return sessions_.size(); }
+    // 第 index 个 Session, 超出数量时取模
+    std::shared_ptr<Ort::Session> Get(size_t index) const { return sessions_[index % sessions_.size()]; }
+    // 轮流返回各个 Session, 供调用方为每个 Session 建立独占的推理状态
+    std::shared_ptr<Ort::Session> Next() { return Get(next_++); }
+
+private:
+    typedef std::function<std::shared_ptr<Ort::Session>(const Ort::SessionOptions &, OrtPrepackedWeightsContainer *)> SessionFactory;
+    // optimized_model_path 非空时, 首个 Session 将优化后的模型保存到该路径
+    void Load(const SessionFactory &create_session, const Ort::SessionOptions &options, const std::string &optimized_model_path = "");
+    // 按缓存加载, 返回 false 时由调用方按原方式加载; map_cache 为 true 时以内存映射加载命中的缓存文件
+    bool LoadCached(Ort::Env &env, const void *model_data, size_t model_data_length, const SessionFactory &create_session, const Ort::SessionOptions &options, bool map_cache);
+
+    int size_;
+    int num_threads_;
+    std::string cache_dir_;
+    GraphOptimizationLevel optimization_level_;
+    std::string execution_provider_;
+    std::shared_ptr<Ort::PrepackedWeightsContainer> prepacked_weights_;
+    // 命中的缓存文件的映射, 需比 Session 存活更久
+    MappedFile cache_file_;
+    std::vector<std::shared_ptr<Ort::Session>> sessions_;
+    std::atomic<size_t> next_;
+};
+
+} // namespace utils
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+namespace utils {
+
+class SimdUtils {
+public:
+    // 当前 CPU 选用的指令集: "avx512", "avx2", "sse4.1" 或 "scalar"
+    static const char *GetIsaName();
+
+    // 将一行交错的 8UC3 像素拆分为三个通道平面并归一化: dest_k[x] = src[3 * x + src_ch[k]] * scale[k] + bias[k]
+    // 启动时根据 CPUID 选择 AVX-512 / AVX2 / SSE4.1 实现, 不支持时回退到标量实现
+    static void NormalizeRow(const uint8_t *src, int width, const int *src_ch, const float *scale, const float *bias, float *dest0, float *dest1, float *dest2);
+
+    // 返回首个最大值的下标, 最大值写入 max_value
+    static int ArgMax(const float *data, int size, float &max_value);
+
+    // 计算 sum(exp(data[i] - offset)), 用于 softmax 的分母
+    static float SumExp(const float *data, int size, float offset);
+
+    // 二值化一行: dest[x] = src[x] > threshold ? 255 : 0, 同时返回置位的像素数,
+    // first / last 为首个和最后一个置位像素的下标, 整行为空时 first = width, last = -1
+    static int ThresholdRow(const float *src, int width, float threshold, uint8_t *dest, int &first, int &last);
+};
+
+} // namespace utils
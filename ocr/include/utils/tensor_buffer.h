@@ -0,0 +1,36 @@
+#pragma once
+
+#include <onnxruntime_cxx_api.h>
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+namespace utils {
+
+// 由调用方持有的 float 张量缓冲区, 仅在需要更大容量时重新分配,
+// 形状不变时复用同一个 Ort::Value, 配合 Ort::IoBinding 实现推理过程无堆分配
+class TensorBuffer {
+public:
+    TensorBuffer();
+
+    // 调整为指定形状并返回数据指针, 原有数据不保证保留
+    float *Reshape(std::initializer_list<int64_t> shape);
+
+    float *data() { return data_.data(); }
+    const float *data() const { return data_.data(); }
+    size_t size() const { return size_; }
+    const std::vector<int64_t> &shape() const { return shape_; }
+
+    Ort::Value &value() { return value_; }
+
+private:
+    std::vector<float> data_;
+    std::vector<int64_t> shape_;
+    size_t size_;
+
+    Ort::MemoryInfo memory_info_;
+    Ort::Value value_;
+};
+
+} // namespace utils
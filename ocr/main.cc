@@ -2,28 +2,88 @@
 #include "utils/ocr_utils.h"
 #include "utils/file_utils.h"
 
+#include <algorithm>
+#include <atomic>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 
 void PrintUsage() {
     std::cout << "Usage: ocr_lite [options]" << std::endl;
     std::cout << "Options:" << std::endl;
+    std::cout << "  --mode <mode>             ocr (default): full pipeline; rec: every image is a single text line, recognition only;" << std::endl;
+    std::cout << "                            det: detection only, boxes are written to <image>_det.txt as x1,y1,...,x4,y4,score" << std::endl;
     std::cout << "  --models_dir <path>       Path to the directory containing the OCR models" << std::endl;
     std::cout << "  --det_path <path>         Path to the detection model" << std::endl;
     std::cout << "  --cls_path <path>         Path to the classification model" << std::endl;
     std::cout << "  --rec_path <path>         Path to the recognition model" << std::endl;
     std::cout << "  --keys_path <path>        Path to the keys file" << std::endl;
     std::cout << "  --image_path <path>       Path to the image file or directory" << std::endl;
-    std::cout << "  --num_threads <int>       Number of threads to use" << std::endl;
+    std::cout << "  --num_threads <int>       Intra-op threads per stage, split evenly across the sessions of that stage" << std::endl;
+    std::cout << "  --global_threads <int>    Size of the thread pool shared by all models, 0 disables it" << std::endl;
+    std::cout << "  --allow_spinning <bool>   Whether threads of the shared pool spin while waiting" << std::endl;
+    std::cout << "  --workers <int>           Number of threads sharing one set of models in directory mode" << std::endl;
+    std::cout << "  --map_models <bool>       Whether to load models through read-only memory mapping" << std::endl;
+    std::cout << "                            weights are shared across processes only for ORT-format models or cached models" << std::endl;
+    std::cout << "  --model_cache_dir <path>  Directory caching optimized models for faster startup" << std::endl;
+    std::cout << "  --warmup <bool>           Whether to warm up all stages before processing and print the time" << std::endl;
+    std::cout << "                            detection uses --det_shape_buckets, or the input shapes of --warmup_image_sizes;" << std::endl;
+    std::cout << "                            without buckets warmup is best-effort: images scaling to other shapes are still cold" << std::endl;
+    std::cout << "  --warmup_image_sizes <list>  Comma separated WxH of representative source images, e.g. 4032x3024,2480x3508," << std::endl;
+    std::cout << "                            defaults to common photo, A4 scan and screenshot sizes" << std::endl;
+    std::cout << "  --warmup_rec_widths <list>  Comma separated line widths at height 32 to warm up recognition, defaults to the width buckets" << std::endl;
+    std::cout << "  --det_sessions <int>      Number of detection sessions, bounds concurrent detections, 0 shares one session;" << std::endl;
+    std::cout << "                            defaults to --workers in directory mode" << std::endl;
+    std::cout << "  --cls_sessions <int>      Number of classification sessions, see --det_sessions" << std::endl;
+    std::cout << "  --rec_sessions <int>      Number of recognition sessions, see --det_sessions" << std::endl;
     std::cout << "  --padding <int>           Padding size" << std::endl;
     std::cout << "  --max_side_len <int>      Maximum side length" << std::endl;
     std::cout << "  --box_score_threshold <float>  Box score threshold" << std::endl;
     std::cout << "  --box_threshold <float>   Box threshold" << std::endl;
     std::cout << "  --unclip_ratio <float>    Unclip ratio" << std::endl;
+    std::cout << "  --box_score_mode <mode>   How box scores are computed: polygon (default) or integral" << std::endl;
+    std::cout << "  --box_extract_mode <mode> How boxes are extracted: contour (default) or component," << std::endl;
+    std::cout << "                            component scores average each row between its extreme pixels, like the contour polygon" << std::endl;
+    std::cout << "  --det_tile_size <int>     Detect in tiles of this size when the detection input is larger, 0 disables it" << std::endl;
+    std::cout << "  --det_tile_overlap <int>  Overlap between adjacent detection tiles" << std::endl;
+    std::cout << "  --det_shape_buckets <list>  Comma separated WxH canvases detection inputs are padded to, e.g. 640x640,1024x1024" << std::endl;
     std::cout << "  --cal_angle <bool>        Whether to calculate the angle" << std::endl;
-    std::cout << "  --cal_most_angle <bool>   Whether to calculate the most angle" << std::endl;
+    std::cout << "  --cal_most_angle <bool>   Whether to calculate the most angle, ignored in rec mode" << std::endl;
+    std::cout << "  --cal_char_scores <bool>  Whether to calculate the score of each character" << std::endl;
+    std::cout << "  --cls_batch_size <int>    Max batch size of angle classification, 1 disables batching" << std::endl;
+    std::cout << "  --rec_batch_size <int>    Max batch size of recognition, 1 disables batching" << std::endl;
+    std::cout << "  --rec_width_buckets <list>  Comma separated width buckets of recognition" << std::endl;
+    std::cout << "  --rec_width_align <int>   Pad unbatched recognition widths to a multiple of this so shapes repeat, 1 (default) keeps exact widths" << std::endl;
+}
+
+std::vector<int> ParseIntList(const std::string &str) {
+    std::vector<int> values;
+    std::stringstream ss(str);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            values.push_back(std::stoi(item));
+        }
+    }
+    return values;
+}
+
+std::vector<cv::Size> ParseSizeList(const std::string &str) {
+    std::vector<cv::Size> sizes;
+    std::stringstream ss(str);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t pos = item.find('x');
+        if (pos != std::string::npos) {
+            sizes.emplace_back(std::stoi(item.substr(0, pos)), std::stoi(item.substr(pos + 1)));
+        }
+    }
+    return sizes;
 }
 
 void GetOpt(std::unordered_map<std::string, std::string> &opt_map, int argc, char **argv) {
@@ -47,23 +107,47 @@ int main(int argc, char **argv) {
     }
 
     // Get options
+    std::string mode = "ocr";
     std::string models_dir;
     std::string det_path, cls_path, rec_path, keys_path;
     std::string image_path, image_dir;
     int num_threads = 4;
+    int workers = 1;
+    bool map_models = false;
+    bool warmup = false;
+    std::vector<int> warmup_rec_widths;
+    std::vector<cv::Size> warmup_image_sizes;
+    std::string model_cache_dir;
+    int det_sessions = 0;
+    int cls_sessions = 0;
+    int rec_sessions = 0;
+    int global_threads = 0;
+    bool allow_spinning = false;
     int padding = 50;
     int max_side_len = 1024;
     float box_score_threshold = 0.6f;
     float box_threshold = 0.3f;
     float unclip_ratio = 2.0f;
+    base::BoxScoreMode box_score_mode = base::BoxScoreMode::kPolygon;
+    base::BoxExtractMode box_extract_mode = base::BoxExtractMode::kContour;
+    int det_tile_size = 0;
+    int det_tile_overlap = 64;
+    std::vector<cv::Size> det_shape_buckets;
     bool cal_angle = true;
     bool cal_most_angle = true;
+    bool cal_char_scores = true;
+    int cls_batch_size = 1;
+    int rec_batch_size = 1;
+    std::vector<int> rec_width_buckets;
+    int rec_width_align = 1;
 
     std::unordered_map<std::string, std::string> opt_map;
     GetOpt(opt_map, argc, argv);
 
     for (auto &opt : opt_map) {
-        if (opt.first == "--models_dir") {
+        if (opt.first == "--mode") {
+            mode = opt.second;
+        } else if (opt.first == "--models_dir") {
             models_dir = opt.second;
         } else if (opt.first == "--det_path") {
             det_path = opt.second;
@@ -77,6 +161,28 @@ int main(int argc, char **argv) {
             image_path = opt.second;
         } else if (opt.first == "--num_threads") {
             num_threads = std::stoi(opt.second);
+        } else if (opt.first == "--global_threads") {
+            global_threads = std::stoi(opt.second);
+        } else if (opt.first == "--allow_spinning") {
+            allow_spinning = opt.second == "true";
+        } else if (opt.first == "--workers") {
+            workers = std::stoi(opt.second);
+        } else if (opt.first == "--map_models") {
+            map_models = opt.second == "true";
+        } else if (opt.first == "--warmup") {
+            warmup = opt.second == "true";
+        } else if (opt.first == "--warmup_rec_widths") {
+            warmup_rec_widths = ParseIntList(opt.second);
+        } else if (opt.first == "--warmup_image_sizes") {
+            warmup_image_sizes = ParseSizeList(opt.second);
+        } else if (opt.first == "--model_cache_dir") {
+            model_cache_dir = opt.second;
+        } else if (opt.first == "--det_sessions") {
+            det_sessions = std::stoi(opt.second);
+        } else if (opt.first == "--cls_sessions") {
+            cls_sessions = std::stoi(opt.second);
+        } else if (opt.first == "--rec_sessions") {
+            rec_sessions = std::stoi(opt.second);
         } else if (opt.first == "--padding") {
             padding = std::stoi(opt.second);
         } else if (opt.first == "--max_side_len") {
@@ -87,16 +193,55 @@ int main(int argc, char **argv) {
             box_threshold = std::stof(opt.second);
         } else if (opt.first == "--unclip_ratio") {
             unclip_ratio = std::stof(opt.second);
+        } else if (opt.first == "--box_score_mode") {
+            if (opt.second == "polygon") {
+                box_score_mode = base::BoxScoreMode::kPolygon;
+            } else if (opt.second == "integral") {
+                box_score_mode = base::BoxScoreMode::kIntegral;
+            } else {
+                std::cerr << "Unknown box_score_mode: " << opt.second << std::endl;
+                return -1;
+            }
+        } else if (opt.first == "--box_extract_mode") {
+            if (opt.second == "contour") {
+                box_extract_mode = base::BoxExtractMode::kContour;
+            } else if (opt.second == "component") {
+                box_extract_mode = base::BoxExtractMode::kComponent;
+            } else {
+                std::cerr << "Unknown box_extract_mode: " << opt.second << std::endl;
+                return -1;
+            }
+        } else if (opt.first == "--det_tile_size") {
+            det_tile_size = std::stoi(opt.second);
+        } else if (opt.first == "--det_tile_overlap") {
+            det_tile_overlap = std::stoi(opt.second);
+        } else if (opt.first == "--det_shape_buckets") {
+            det_shape_buckets = ParseSizeList(opt.second);
         } else if (opt.first == "--cal_angle") {
             cal_angle = opt.second == "true";
         } else if (opt.first == "--cal_most_angle") {
             cal_most_angle = opt.second == "true";
+        } else if (opt.first == "--cal_char_scores") {
+            cal_char_scores = opt.second == "true";
+        } else if (opt.first == "--cls_batch_size") {
+            cls_batch_size = std::stoi(opt.second);
+        } else if (opt.first == "--rec_batch_size") {
+            rec_batch_size = std::stoi(opt.second);
+        } else if (opt.first == "--rec_width_buckets") {
+            rec_width_buckets = ParseIntList(opt.second);
+        } else if (opt.first == "--rec_width_align") {
+            rec_width_align = std::stoi(opt.second);
         } else {
             std::cerr << "Unknown option: " << opt.first << std::endl;
             return -1;
         }
     }
 
+    if (mode != "ocr" && mode != "rec" && mode != "det") {
+        std::cerr << "Unknown mode: " << mode << std::endl;
+        return -1;
+    }
+
     // 模型参数检查
     if (models_dir.empty()) {
         std::cerr << "models_dir is empty" << std::endl;
@@ -138,23 +283,123 @@ int main(int argc, char **argv) {
         return -1;
     }
 
-    // 初始化 OCR 模型
-    model::OcrLite ocr_lite;
-    ocr_lite.Init(det_path, cls_path, rec_path, keys_path);
-    ocr_lite.SetNumThreads(num_threads);
-    if (opt_map.count("--output_console")) {
-        ocr_lite.SetOutputConsole(true);
-    }
-    if (opt_map.count("--output_part_image")) {
-        ocr_lite.SetOutputPartImage(true);
-    }
-    if (opt_map.count("--output_result_text")) {
-        ocr_lite.SetOutputResultText(true);
-    }
-    if (opt_map.count("--output_result_image")) {
-        ocr_lite.SetOutputResultImage(true);
+    // 初始化 OCR 模型, 线程数需在加载模型前设置
+    auto init_ocr_lite = [&](model::OcrLite &ocr_lite, int threads) {
+        ocr_lite.SetNumThreads(threads);
+        ocr_lite.SetDetShapeBuckets(det_shape_buckets);
+        ocr_lite.SetNumSessions(det_sessions, cls_sessions, rec_sessions);
+        ocr_lite.SetMapModels(map_models);
+        ocr_lite.SetModelCacheDir(model_cache_dir);
+        if (global_threads > 0) {
+            ocr_lite.SetGlobalThreadPool(global_threads, 1, allow_spinning);
+        }
+        ocr_lite.Init(det_path, cls_path, rec_path, keys_path);
+        ocr_lite.SetCalCharScores(cal_char_scores);
+        ocr_lite.SetBoxScoreMode(box_score_mode);
+        ocr_lite.SetBoxExtractMode(box_extract_mode);
+        // rec 与 det 模式传入的是 cv::imread 读取的 BGR 图像
+        ocr_lite.SetInputColorOrder(base::ColorOrder::kBgr);
+        ocr_lite.SetDetTiling(det_tile_size, det_tile_overlap);
+        ocr_lite.SetClsBatchSize(cls_batch_size);
+        ocr_lite.SetRecBatchSize(rec_batch_size);
+        if (!rec_width_buckets.empty()) {
+            ocr_lite.SetRecWidthBuckets(rec_width_buckets);
+        }
+        ocr_lite.SetRecWidthAlign(rec_width_align);
+        if (opt_map.count("--output_console")) {
+            ocr_lite.SetOutputConsole(true);
+        }
+        if (opt_map.count("--output_part_image")) {
+            ocr_lite.SetOutputPartImage(true);
+        }
+        if (opt_map.count("--output_result_text")) {
+            ocr_lite.SetOutputResultText(true);
+        }
+        if (opt_map.count("--output_result_image")) {
+            ocr_lite.SetOutputResultImage(true);
+        }
+        if (warmup) {
+            // 未设置尺寸分桶时, 由代表性的原图尺寸推算检测输入尺寸, 不保证其余尺寸的首次处理是热的
+            std::vector<cv::Size> det_sizes = det_shape_buckets;
+            if (det_sizes.empty()) {
+                det_sizes = model::OcrLite::GetDetWarmupSizes(max_side_len, padding, warmup_image_sizes);
+            }
+            base::WarmupResult warmup_result = ocr_lite.Warmup(det_sizes, warmup_rec_widths);
+            std::cout << "warmup det_time: " << warmup_result.det_time << " cls_time: " << warmup_result.cls_time
+                      << " rec_time: " << warmup_result.rec_time << " full_time: " << warmup_result.full_time << std::endl;
+        }
+    };
+
+    // 仅识别: 每张图像为一行文本, 分块读入后批量识别, 按 "路径\t文本" 输出
+    if (mode == "rec") {
+        std::vector<std::string> files;
+        if (utils::FileUtils::IsDirectory(image_path)) {
+            utils::FileUtils::ListDir(image_path, files);
+        } else {
+            files.push_back(image_path);
+        }
+
+        model::OcrLite ocr_lite;
+        init_ocr_lite(ocr_lite, num_threads);
+
+        const size_t chunk_size = 256;
+        double sum_rec_time = 0.0;
+        for (size_t begin = 0; begin < files.size(); begin += chunk_size) {
+            size_t end = std::min(files.size(), begin + chunk_size);
+            std::vector<std::string> chunk_files;
+            std::vector<cv::Mat> images;
+            for (size_t i = begin; i < end; ++i) {
+                cv::Mat image = cv::imread(files[i], cv::IMREAD_COLOR);
+                if (image.empty()) {
+                    std::cerr << "Failed to read image: " << files[i] << std::endl;
+                    continue;
+                }
+                chunk_files.push_back(files[i]);
+                images.push_back(image);
+            }
+
+            std::vector<base::Angle> angles;
+            // 各图像相互独立, 不按多数方向统一
+            std::vector<base::TextLine> text_lines = ocr_lite.RecognizeLines(images, cal_angle, false, &angles);
+            for (size_t i = 0; i < text_lines.size(); ++i) {
+                std::cout << chunk_files[i] << "\t" << text_lines[i].text << std::endl;
+                sum_rec_time += angles[i].time + text_lines[i].time;
+            }
+        }
+
+        // LOG_INFO
+        std::cout << "=====Result=====" << std::endl;
+        std::cout << "lines: " << files.size() << " sum_rec_time: " << sum_rec_time << std::endl;
+        return 0;
     }
 
+    // 处理单张图像, det 模式下只检测并写出文本框
+    auto process_image = [&](model::OcrLite &ocr_lite, const std::string &dir, const std::string &name, double &det_time, double &full_time) {
+        if (mode == "det") {
+            std::string path = utils::FileUtils::JoinPath(dir, name);
+            cv::Mat image = cv::imread(path, cv::IMREAD_COLOR);
+            if (image.empty()) {
+                std::cerr << "Failed to read image: " << path << std::endl;
+                det_time = full_time = 0.0;
+                return;
+            }
+            base::DetResult result = ocr_lite.DetectBoxes(image, padding, max_side_len, box_score_threshold, box_threshold, unclip_ratio);
+
+            std::ofstream ofs(path + "_det.txt");
+            for (const auto &box : result.boxes) {
+                for (const auto &point : box.points) {
+                    ofs << point.x << "," << point.y << ",";
+                }
+                ofs << box.score << "\n";
+            }
+            det_time = full_time = result.det_time;
+            return;
+        }
+        base::OcrResult result = ocr_lite.Process(dir, name, padding, max_side_len, box_score_threshold, box_threshold, unclip_ratio, cal_angle, cal_most_angle);
+        det_time = result.det_time;
+        full_time = result.full_time;
+    };
+
     // LOG_INFO
 
     double sum_det_time = 0.0;
@@ -164,24 +409,55 @@ int main(int argc, char **argv) {
     if (utils::FileUtils::IsDirectory(image_path)) {
         std::vector<std::string> files;
         utils::FileUtils::ListDir(image_path, files);
-        for (auto &image_name : files) {
-            base::OcrResult result = ocr_lite.Process(image_dir, image_name, padding, max_side_len, box_score_threshold, box_threshold, unclip_ratio, cal_angle, cal_most_angle);
-            // LOG_INFO
-            std::cout << "det_time: " << result.det_time << " full_time: " << result.full_time << std::endl;
 
-            sum_det_time += result.det_time;
-            sum_full_time += result.full_time;
+        // 所有 worker 共用同一个 OcrLite, 模型只加载一次. 同一 Session 的推理共用该 Session 的 intra-op 线程池,
+        // 多个 worker 时未指定 Session 数的阶段按 worker 数加载 Session, 使各 worker 的推理可以真正并行;
+        // 线程数只在 SessionPool 中按 Session 数均分一次, 总数不超过 num_threads 与核数
+        int hardware_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        workers = std::max(1, std::min(workers, static_cast<int>(files.size())));
+        if (workers > 1) {
+            if (det_sessions <= 0) det_sessions = workers;
+            if (cls_sessions <= 0) cls_sessions = workers;
+            if (rec_sessions <= 0) rec_sessions = workers;
+        }
+        model::OcrLite ocr_lite;
+        init_ocr_lite(ocr_lite, std::min(num_threads, hardware_threads));
+
+        std::atomic<size_t> next_index(0);
+        std::mutex result_mutex;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < workers; ++i) {
+            threads.emplace_back([&]() {
+                for (size_t index = next_index++; index < files.size(); index = next_index++) {
+                    double det_time, full_time;
+                    process_image(ocr_lite, image_dir, files[index], det_time, full_time);
+
+                    std::lock_guard<std::mutex> lock(result_mutex);
+                    // LOG_INFO
+                    std::cout << "det_time: " << det_time << " full_time: " << full_time << std::endl;
+
+                    sum_det_time += det_time;
+                    sum_full_time += full_time;
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
         }
     } else {
+        model::OcrLite ocr_lite;
+        init_ocr_lite(ocr_lite, num_threads);
+
         image_dir = utils::FileUtils::GetDirName(image_path);
         std::string image_name = utils::FileUtils::GetFileName(image_path);
 
-        base::OcrResult result = ocr_lite.Process(image_dir, image_name, padding, max_side_len, box_score_threshold, box_threshold, unclip_ratio, cal_angle, cal_most_angle);
+        double det_time, full_time;
+        process_image(ocr_lite, image_dir, image_name, det_time, full_time);
         // LOG_INFO
-        std::cout << "det_time: " << result.det_time << " full_time: " << result.full_time << std::endl;
+        std::cout << "det_time: " << det_time << " full_time: " << full_time << std::endl;
 
-        sum_det_time += result.det_time;
-        sum_full_time += result.full_time;
+        sum_det_time += det_time;
+        sum_full_time += full_time;
     }
 
     // LOG_INFO
@@ -1,9 +1,8 @@
 #include "model/angle_net.h"
 #include "utils/ocr_utils.h"
-#include "utils/image_utils.h"
 #include "utils/time_utils.h"
 
-#include <array>
+#include <algorithm>
 #include <numeric>
 
 namespace model {
@@ -11,24 +10,101 @@ namespace model {
 AngleNet::AngleNet()
         : is_output_debug_image_(false),
           num_threads_(0),
-          env_(Ort::Env(ORT_LOGGING_LEVEL_ERROR, "AngleNet")),
+          batch_size_(1),
+          env_(),
           session_options_(),
+          optimization_level_(ORT_ENABLE_ALL),
+          model_cache_dir_(),
           input_name_(),
-          output_name_() {}
+          output_name_(),
+          num_classes_(2) {}
 
 AngleNet::~AngleNet() {}
 
 void AngleNet::SetNumThreads(int num_threads) {
     num_threads_ = num_threads;
     session_options_.SetIntraOpNumThreads(num_threads);
-    session_options_.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+    sessions_.SetNumThreads(num_threads);
+    optimization_level_ = GraphOptimizationLevel::ORT_ENABLE_EXTENDED;
+    session_options_.SetGraphOptimizationLevel(optimization_level_);
+}
+
+void AngleNet::SetEnv(const std::shared_ptr<Ort::Env> &env, bool use_global_thread_pool) {
+    env_ = env;
+    if (use_global_thread_pool) {
+        session_options_.DisablePerSessionThreads();
+    }
+}
+
+void AngleNet::SetNumSessions(int num_sessions) {
+    sessions_.SetSize(num_sessions);
+}
+
+void AngleNet::SetModelCacheDir(const std::string &model_cache_dir) {
+    model_cache_dir_ = model_cache_dir;
+}
+
+void AngleNet::SetPrepackedWeights(const std::shared_ptr<Ort::PrepackedWeightsContainer> &prepacked_weights) {
+    sessions_.SetPrepackedWeights(prepacked_weights);
+}
+
+void AngleNet::SetBatchSize(int batch_size) {
+    batch_size_ = std::max(1, batch_size);
 }
 
 void AngleNet::Init(const std::string &model_path) {
-    session_ = std::make_shared<Ort::Session>(env_, model_path.c_str(), session_options_);
+    if (!env_) {
+        env_ = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_ERROR, "AngleNet");
+    }
+    sessions_.SetCacheDir(model_cache_dir_, optimization_level_);
+    sessions_.Init(*env_, model_path, session_options_);
+    InitContexts();
+}
+
+void AngleNet::Init(const base::ModelBuffer &model) {
+    if (!env_) {
+        env_ = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_ERROR, "AngleNet");
+    }
+    sessions_.SetCacheDir(model_cache_dir_, optimization_level_);
+    sessions_.Init(*env_, model.data, model.length, session_options_);
+    InitContexts();
+}
+
+void AngleNet::InitContexts() {
+    std::shared_ptr<Ort::Session> session = sessions_.Get(0);
+
+    utils::OcrUtils::GetInputName(session, input_name_);
+    utils::OcrUtils::GetOutputName(session, output_name_);
 
-    utils::OcrUtils::GetInputName(session_, input_name_);
-    utils::OcrUtils::GetOutputName(session_, output_name_);
+    // 输出形状为 [N, num_classes], 类别数固定, 可预先分配输出缓冲区
+    std::vector<int64_t> output_shape = session->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+    if (!output_shape.empty() && output_shape.back() > 0) {
+        num_classes_ = output_shape.back();
+    }
+    // 每个 Context 绑定一个 Session, 池的容量即 Session 数, 为 0 时不限
+    contexts_.Reset([this]() { return CreateContext(); }, sessions_.size());
+}
+
+std::unique_ptr<AngleNet::Context> AngleNet::CreateContext() {
+    std::unique_ptr<Context> context(new Context());
+    context->session = sessions_.Next();
+    context->binding.reset(new Ort::IoBinding(*context->session));
+    return context;
+}
+
+void AngleNet::Warmup() {
+    std::vector<cv::Mat> images(batch_size_, cv::Mat(dest_height_, dest_width_, CV_8UC3, cv::Scalar(255, 255, 255)));
+    std::vector<base::Angle> angles(images.size());
+
+    // 同时借出全部 Context, 保证每个 Session 都被预热
+    std::vector<utils::ObjectPool<Context>::Lease> contexts;
+    for (int i = 0; i < sessions_.count(); ++i) {
+        contexts.emplace_back(contexts_.Acquire());
+        runBatch(*contexts.back(), images, 0, 1, angles);
+        if (batch_size_ > 1) {
+            runBatch(*contexts.back(), images, 0, batch_size_, angles);
+        }
+    }
 }
 
 std::vector<base::Angle> AngleNet::GetAngles(const std::vector<cv::Mat> &images, const std::string &path, const std::string &image_name, bool cal_angle, bool cal_most_angle) {
@@ -36,15 +112,30 @@ std::vector<base::Angle> AngleNet::GetAngles(const std::vector<cv::Mat> &images,
     std::vector<base::Angle> angles(size);
 
     if (cal_angle) {
-        for (int i = 0; i < size; i++) {
-            double start_time = utils::TimeUtils::now();
-            auto image = utils::ImageUtils::AdjustImageSize(images[i], dest_width_, dest_height_);
-            angles[i] = run(image);
-            double end_time = utils::TimeUtils::now();
-            angles[i].time = end_time - start_time;
-            // LOG(INFO) << "AngleNet time: " << angles[i].time;
-
-            if (is_output_debug_image_) {
+        utils::ObjectPool<Context>::Lease context = contexts_.Acquire();
+        if (batch_size_ > 1) {
+            // 输入尺寸固定为 192x32, 可直接拼成 [N, 3, 32, 192] 批量推理
+            for (int begin = 0; begin < size; begin += batch_size_) {
+                int end = std::min(size, begin + batch_size_);
+                double start_time = utils::TimeUtils::now();
+                runBatch(*context, images, begin, end, angles);
+                double batch_time = utils::TimeUtils::now() - start_time;
+                for (int i = begin; i < end; i++) {
+                    angles[i].time = batch_time / (end - begin);
+                }
+            }
+        } else {
+            for (int i = 0; i < size; i++) {
+                double start_time = utils::TimeUtils::now();
+                runBatch(*context, images, i, i + 1, angles);
+                double end_time = utils::TimeUtils::now();
+                angles[i].time = end_time - start_time;
+                // LOG(INFO) << "AngleNet time: " << angles[i].time;
+            }
+        }
+
+        if (is_output_debug_image_) {
+            for (int i = 0; i < size; i++) {
                 std::string angle_image_path = path + "/" + image_name + "_angle_" + std::to_string(i) + ".jpg";
                 cv::Mat angle_image = images[i].clone();
                 cv::imwrite(angle_image_path, angle_image);
@@ -52,13 +143,9 @@ std::vector<base::Angle> AngleNet::GetAngles(const std::vector<cv::Mat> &images,
         }
 
         if (cal_most_angle) {
-            std::vector<int> indexes = utils::OcrUtils::GetAngleIndexes(angles);
-            double sum = std::accumulate(indexes.begin(), indexes.end(), 0.0);
-            double half = size / 2;
-
-            int most_index = sum < half ? 0 : 1;
+            int most_index = utils::OcrUtils::GetMostAngleIndex(angles);
             for (int i = 0; i < size; i++) {
-                angles[i].index = indexes[most_index];
+                angles[i].index = most_index;
             }
         }
     } else {
@@ -69,30 +156,29 @@ std::vector<base::Angle> AngleNet::GetAngles(const std::vector<cv::Mat> &images,
     return angles;
 }
 
-base::Angle AngleNet::run(const cv::Mat &src) {
-    std::vector<float> input_tensor_values = utils::OcrUtils::SubstractMeanNormalize(src, mean_, norm_);
-
-    std::array<int64_t, 4> input_shape{1, src.channels(), src.rows, src.cols};
-
-    Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-
-    Ort::Value input_tensor = Ort::Value::CreateTensor<float>(memory_info, input_tensor_values.data(), input_tensor_values.size(), input_shape.data(), input_shape.size());
-    assert(input_tensor.IsTensor());
-
-    std::vector<const char *> input_names = {input_name_.c_str()};
-    std::vector<const char *> output_names = {output_name_.c_str()};
-    auto output_tensor = session_->Run(Ort::RunOptions{nullptr}, input_names.data(), &input_tensor, input_names.size(), output_names.data(), output_names.size());
+void AngleNet::runBatch(Context &context, const std::vector<cv::Mat> &images, int begin, int end, std::vector<base::Angle> &angles) {
+    int batch = end - begin;
+    size_t image_size = 3 * dest_height_ * dest_width_;
+    float *input_data = context.input_buffer.Reshape({batch, 3, dest_height_, dest_width_});
+    for (int i = begin; i < end; i++) {
+        // 等比缩放至高度 32, 宽度不足 192 时以白色填充, 超出部分裁掉
+        int scaled_width = static_cast<int>(images[i].cols * static_cast<float>(dest_height_) / images[i].rows);
+        utils::OcrUtils::ResizeNormalize(images[i], std::max(1, scaled_width), dest_height_, dest_width_, mean_, norm_, true, cv::Scalar(255, 255, 255), input_data + (i - begin) * image_size);
+    }
+    const float *output = context.output_buffer.Reshape({batch, num_classes_});
 
-    std::vector<int64_t> output_shape(output_tensor[0].GetTensorTypeAndShapeInfo().GetShape());
-    int64_t output_count = std::accumulate(output_shape.begin(), output_shape.end(), 1, std::multiplies<int64_t>());
+    context.binding->BindInput(input_name_.c_str(), context.input_buffer.value());
+    context.binding->BindOutput(output_name_.c_str(), context.output_buffer.value());
+    context.session->Run(Ort::RunOptions{nullptr}, *context.binding);
 
-    float *output = output_tensor.front().GetTensorMutableData<float>();
-    std::vector<float> output_values(output, output + output_count);
-    
-    return ScoreToAngle(output_values);
+    // 逐行取最大值, 直接读取输出缓冲区
+    base::Span<const float> output_values(output, batch * num_classes_);
+    for (int i = 0; i < batch; i++) {
+        angles[begin + i] = ScoreToAngle(output_values.subspan(i * num_classes_, num_classes_));
+    }
 }
 
-base::Angle AngleNet::ScoreToAngle(const std::vector<float> &output_values) {
+base::Angle AngleNet::ScoreToAngle(base::Span<const float> output_values) {
     int max_index = 0;
     float max_value = output_values.empty() ? -1000.0f : output_values[0];
 
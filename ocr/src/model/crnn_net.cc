@@ -1,28 +1,79 @@
 #include "model/crnn_net.h"
 #include "utils/ocr_utils.h"
+#include "utils/simd_utils.h"
 #include "utils/time_utils.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <map>
 #include <numeric>
 
 namespace model {
 
+namespace {
+
+// 向上对齐到 align 的倍数
+int AlignWidth(int width, int align) {
+    return (width + align - 1) / align * align;
+}
+
+} // namespace
+
 CrnnNet::CrnnNet()
         : is_output_debug_image_(false),
           num_threads_(0),
-          env_(Ort::Env(ORT_LOGGING_LEVEL_ERROR, "CrnnNet")),
+          batch_size_(1),
+          is_cal_char_scores_(true),
+          width_buckets_{64, 128, 192, 256, 384, 512, 768, 1024},
+          width_align_(1),
+          env_(),
           session_options_(),
+          optimization_level_(ORT_ENABLE_ALL),
+          model_cache_dir_(),
           input_name_(),
-          output_name_() {}
+          output_name_(),
+          num_classes_(0),
+          memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)) {}
 
 CrnnNet::~CrnnNet() {}
 
 void CrnnNet::Init(const std::string &model_path, const std::string &keys_path) {
-    session_ = std::make_shared<Ort::Session>(env_, model_path.c_str(), session_options_);
+    if (!env_) {
+        env_ = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_ERROR, "CrnnNet");
+    }
+    sessions_.SetCacheDir(model_cache_dir_, optimization_level_);
+    sessions_.Init(*env_, model_path, session_options_);
+    InitContexts();
+    LoadKeys(keys_path);
+}
+
+void CrnnNet::Init(const base::ModelBuffer &model, const std::string &keys_path) {
+    if (!env_) {
+        env_ = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_ERROR, "CrnnNet");
+    }
+    sessions_.SetCacheDir(model_cache_dir_, optimization_level_);
+    sessions_.Init(*env_, model.data, model.length, session_options_);
+    InitContexts();
+    LoadKeys(keys_path);
+}
 
-    utils::OcrUtils::GetInputName(session_, input_name_);
-    utils::OcrUtils::GetOutputName(session_, output_name_);
+void CrnnNet::InitContexts() {
+    std::shared_ptr<Ort::Session> session = sessions_.Get(0);
 
+    utils::OcrUtils::GetInputName(session, input_name_);
+    utils::OcrUtils::GetOutputName(session, output_name_);
+
+    // 输出形状为 [T, N, C]
+    std::vector<int64_t> output_shape = session->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+    if (output_shape.size() == 3 && output_shape[2] > 0) {
+        num_classes_ = output_shape[2];
+    }
+    // 每个 Context 绑定一个 Session, 池的容量即 Session 数, 为 0 时不限
+    contexts_.Reset([this]() { return CreateContext(); }, sessions_.size());
+}
+
+void CrnnNet::LoadKeys(const std::string &keys_path) {
     std::ifstream infile(keys_path);
     std::string line;
     if (infile) {
@@ -39,88 +90,227 @@ void CrnnNet::Init(const std::string &model_path, const std::string &keys_path)
     // LOG_INFO << "Keys size: " << keys_.size();
 }
 
+std::unique_ptr<CrnnNet::Context> CrnnNet::CreateContext() {
+    std::unique_ptr<Context> context(new Context());
+    context->session = sessions_.Next();
+    context->binding.reset(new Ort::IoBinding(*context->session));
+    context->num_classes = num_classes_;
+    return context;
+}
+
 void CrnnNet::SetNumThreads(int num_threads) {
     num_threads_ = num_threads;
     session_options_.SetIntraOpNumThreads(num_threads);
-    session_options_.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+    sessions_.SetNumThreads(num_threads);
+    optimization_level_ = GraphOptimizationLevel::ORT_ENABLE_EXTENDED;
+    session_options_.SetGraphOptimizationLevel(optimization_level_);
+}
+
+void CrnnNet::SetEnv(const std::shared_ptr<Ort::Env> &env, bool use_global_thread_pool) {
+    env_ = env;
+    if (use_global_thread_pool) {
+        session_options_.DisablePerSessionThreads();
+    }
+}
+
+void CrnnNet::SetNumSessions(int num_sessions) {
+    sessions_.SetSize(num_sessions);
+}
+
+void CrnnNet::SetModelCacheDir(const std::string &model_cache_dir) {
+    model_cache_dir_ = model_cache_dir;
+}
+
+void CrnnNet::SetPrepackedWeights(const std::shared_ptr<Ort::PrepackedWeightsContainer> &prepacked_weights) {
+    sessions_.SetPrepackedWeights(prepacked_weights);
+}
+
+void CrnnNet::SetBatchSize(int batch_size) {
+    batch_size_ = std::max(1, batch_size);
+}
+
+void CrnnNet::SetWidthBuckets(const std::vector<int> &width_buckets) {
+    width_buckets_ = width_buckets;
+    std::sort(width_buckets_.begin(), width_buckets_.end());
+}
+
+void CrnnNet::SetWidthAlign(int width_align) {
+    width_align_ = std::max(1, width_align);
+}
+
+void CrnnNet::SetCalCharScores(bool cal_char_scores) {
+    is_cal_char_scores_ = cal_char_scores;
+}
+
+int CrnnNet::GetBucketWidth(int width) const {
+    for (int bucket_width : width_buckets_) {
+        if (width <= bucket_width) return bucket_width;
+    }
+    // 超出最大桶宽, 按 32 对齐
+    return AlignWidth(width, 32);
 }
 
-base::TextLine CrnnNet::ScoreToTextLine(const std::vector<float> &output_values, int h, int w) {
+base::TextLine CrnnNet::ScoreToTextLine(base::Span<const float> output, int steps, int num_classes, int step_stride) {
     // 将输出的分数转换为文本行
     int size = keys_.size();
     std::string str_result;
     std::vector<float> scores;
     int last_index = -1;
 
-    std::vector<float> exp_values(w);
-
-    // 逐行计算最大值
-    for (int i = 0; i < h; ++i) {
-        // Softmax 计算
-        float sum = 0.0f;
-        int max_index = 0;
-        float max_value = -1000.0f;
-
-        for (int j = 0; j < w; ++j) {
-            exp_values[j] = exp(output_values[i * w + j]);
-            sum += exp_values[j];
-            if (exp_values[j] > max_value) {
-                max_value = exp_values[j];
-                max_index = j;
-            }
-        }
-        max_value /= sum; // Softmax 归一化
+    // 逐行计算最大值, 直接在原始 logits 上求 argmax, 只对输出的字符计算 softmax 得分
+    for (int i = 0; i < steps; ++i) {
+        base::Span<const float> logits = output.subspan(static_cast<size_t>(i) * step_stride, num_classes);
+        float max_value = 0.0f;
+        int max_index = utils::SimdUtils::ArgMax(logits.data(), logits.size(), max_value);
 
         // 过滤掉相邻重复的字符
         if (max_index > 0 && max_index < size && max_index != last_index) {
             str_result += keys_[max_index];
-            scores.push_back(max_value);
+            if (is_cal_char_scores_) {
+                // softmax(max) = 1 / sum(exp(x - max))
+                scores.push_back(1.0f / utils::SimdUtils::SumExp(logits.data(), logits.size(), max_value));
+            }
         }
         last_index = max_index;
     }
     return {str_result, scores};
 }
 
-base::TextLine CrnnNet::run(const cv::Mat &src) {
-    float scale = static_cast<float>(dest_height_) / src.rows;
-    int dest_width = static_cast<int>(src.cols * scale);
+void CrnnNet::runBatch(Context &context, const std::vector<cv::Mat> &images, const std::vector<int> &indexes, int bucket_width, std::vector<base::TextLine> &text_lines) {
+    int batch = indexes.size();
+    int channels = 3;
+    size_t image_size = channels * static_cast<size_t>(dest_height_) * bucket_width;
 
-    cv::Mat src_resize;
-    cv::resize(src, src_resize, cv::Size(dest_width, dest_height_));
+    float *input_data = context.input_buffer.Reshape({batch, channels, dest_height_, bucket_width});
 
-    std::vector<float> input_data = utils::OcrUtils::SubstractMeanNormalize(src_resize, mean_, norm_);
-    std::vector<int64_t> input_shape = {1, src_resize.channels(), src_resize.rows, src_resize.cols};
+    std::vector<int> widths(batch);
+    for (int b = 0; b < batch; ++b) {
+        const cv::Mat &src = images[indexes[b]];
+        int width = std::min(bucket_width, std::max(1, static_cast<int>(src.cols * static_cast<float>(dest_height_) / src.rows)));
+        widths[b] = width;
 
-    Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-    Ort::Value input_tensor = Ort::Value::CreateTensor<float>(memory_info, input_data.data(), input_data.size(), input_shape.data(), input_shape.size());
-    
-    std::vector<const char*> input_names = {input_name_.c_str()};
-    std::vector<const char*> output_names = {output_name_.c_str()};
-    std::vector<Ort::Value> output_tensors = session_->Run(Ort::RunOptions{nullptr}, input_names.data(), &input_tensor, input_names.size(), output_names.data(), output_names.size());
+        // 填充值取均值, 即归一化后的 0
+        float *dest = input_data + b * image_size;
+        utils::OcrUtils::ResizeNormalize(src, width, dest_height_, bucket_width, mean_, norm_, true, cv::Scalar(mean_[0], mean_[1], mean_[2]), dest);
+    }
+    Ort::IoBinding &binding = *context.binding;
+    binding.BindInput(input_name_.c_str(), context.input_buffer.value());
+
+    // 输出形状为 [T, N, C]
+    int steps = 0;
+    const float *output = nullptr;
+    // ORT 分配的输出, 只在本次解码期间使用; IoBinding 同样持有它, 解码后需解除绑定才会释放
+    std::vector<Ort::Value> output_tensors;
+    auto time_steps = context.time_steps.find(bucket_width);
+    if (time_steps != context.time_steps.end() && context.num_classes > 0) {
+        steps = time_steps->second;
+        output = context.output_buffer.Reshape({steps, batch, context.num_classes});
+        binding.BindOutput(output_name_.c_str(), context.output_buffer.value());
+        context.session->Run(Ort::RunOptions{nullptr}, binding);
+    } else {
+        binding.BindOutput(output_name_.c_str(), memory_info_);
+        context.session->Run(Ort::RunOptions{nullptr}, binding);
+        output_tensors = binding.GetOutputValues();
 
-    std::vector<int64_t> output_shape = output_tensors.front().GetTensorTypeAndShapeInfo().GetShape();
-    int64_t output_count = std::accumulate(output_shape.begin(), output_shape.end(), 1, std::multiplies<int64_t>());
+        std::vector<int64_t> output_shape = output_tensors.front().GetTensorTypeAndShapeInfo().GetShape();
+        steps = output_shape[0];
+        context.num_classes = output_shape[2];
+        context.time_steps[bucket_width] = steps;
+        output = output_tensors.front().GetTensorData<float>();
+    }
+    int num_classes = context.num_classes;
+    base::Span<const float> output_values(output, static_cast<size_t>(steps) * batch * num_classes);
 
-    float* output = output_tensors.front().GetTensorMutableData<float>();
-    std::vector<float> output_values(output, output + output_count);
-    return ScoreToTextLine(output_values, output_shape[0], output_shape[2]);
+    for (int b = 0; b < batch; ++b) {
+        // 只解码覆盖原图宽度的时间步, 忽略填充区域
+        int valid_steps = std::min(steps, static_cast<int>(std::ceil(static_cast<float>(steps) * widths[b] / bucket_width)));
+        size_t offset = static_cast<size_t>(b) * num_classes;
+        text_lines[indexes[b]] = ScoreToTextLine(output_values.subspan(offset, output_values.size() - offset), valid_steps, num_classes, batch * num_classes);
+    }
+    if (!output_tensors.empty()) {
+        binding.ClearBoundOutputs();
+    }
+}
+
+void CrnnNet::Warmup(const std::vector<int> &widths) {
+    // 实际推理的输入宽度: 批量模式下为桶宽, 否则为缩放后的宽度 (设置了对齐时为对齐后的宽度)
+    std::vector<int> input_widths;
+    for (int width : widths.empty() ? width_buckets_ : widths) {
+        int input_width = batch_size_ > 1 ? GetBucketWidth(std::max(1, width)) : AlignWidth(std::max(1, width), width_align_);
+        if (std::find(input_widths.begin(), input_widths.end(), input_width) == input_widths.end()) {
+            input_widths.push_back(input_width);
+        }
+    }
+
+    std::vector<int> single_indexes(1, 0);
+    std::vector<int> batch_indexes(batch_size_);
+    std::iota(batch_indexes.begin(), batch_indexes.end(), 0);
+    std::vector<base::TextLine> text_lines(batch_size_);
+
+    // 同时借出全部 Context, 保证每个 Session 都被预热
+    std::vector<utils::ObjectPool<Context>::Lease> contexts;
+    for (int i = 0; i < sessions_.count(); ++i) {
+        contexts.emplace_back(contexts_.Acquire());
+        for (int input_width : input_widths) {
+            std::vector<cv::Mat> images(batch_size_, cv::Mat(dest_height_, input_width, CV_8UC3, cv::Scalar(255, 255, 255)));
+            runBatch(*contexts.back(), images, single_indexes, input_width, text_lines);
+            if (batch_size_ > 1) {
+                runBatch(*contexts.back(), images, batch_indexes, input_width, text_lines);
+            }
+        }
+    }
 }
 
 std::vector<base::TextLine> CrnnNet::GetTextLines(const std::vector<cv::Mat> &images, const std::string &path, const std::string &image_name) {
     int size = images.size();
     std::vector<base::TextLine> text_lines(size);
 
-    for (int i = 0; i < size; ++i) {
-        if (is_output_debug_image_) {
+    if (is_output_debug_image_) {
+        for (int i = 0; i < size; ++i) {
             std::string text_image_path = path + "/" + image_name + "_text_" + std::to_string(i) + ".jpg";
             cv::Mat text_image = images[i].clone();
             cv::imwrite(text_image_path, text_image);
         }
+    }
+
+    if (size == 0) return text_lines;
+    utils::ObjectPool<Context>::Lease context = contexts_.Acquire();
+
+    if (batch_size_ <= 1) {
+        for (int i = 0; i < size; ++i) {
+            double start = utils::TimeUtils::now();
+            int width = static_cast<int>(images[i].cols * static_cast<float>(dest_height_) / images[i].rows);
+            context->batch_indexes.assign(1, i);
+            runBatch(*context, images, context->batch_indexes, AlignWidth(std::max(1, width), width_align_), text_lines);
+            double end = utils::TimeUtils::now();
+            text_lines[i].time = end - start;
+        }
+        return text_lines;
+    }
+
+    // 按缩放后的宽度分桶
+    std::map<int, std::vector<int>> buckets;
+    for (int i = 0; i < size; ++i) {
+        int width = static_cast<int>(images[i].cols * static_cast<float>(dest_height_) / images[i].rows);
+        buckets[GetBucketWidth(std::max(1, width))].push_back(i);
+    }
 
-        double start = utils::TimeUtils::now();
-        text_lines[i] = run(images[i]);
-        double end = utils::TimeUtils::now();
-        text_lines[i].time = end - start;
+    // 每个桶按 batch_size_ 切分, 一次推理一批
+    for (const auto &bucket : buckets) {
+        const std::vector<int> &bucket_indexes = bucket.second;
+        for (size_t begin = 0; begin < bucket_indexes.size(); begin += batch_size_) {
+            size_t end = std::min(bucket_indexes.size(), begin + batch_size_);
+            std::vector<int> indexes(bucket_indexes.begin() + begin, bucket_indexes.begin() + end);
+
+            double start_time = utils::TimeUtils::now();
+            runBatch(*context, images, indexes, bucket.first, text_lines);
+            double batch_time = utils::TimeUtils::now() - start_time;
+
+            // 批次耗时均摊到每一行
+            for (int index : indexes) {
+                text_lines[index].time = batch_time / indexes.size();
+            }
+        }
     }
     return text_lines;
 }
@@ -1,15 +1,22 @@
 #include "model/db_net.h"
 #include "utils/ocr_utils.h"
+#include "utils/simd_utils.h"
 #include "utils/time_utils.h"
 
+#include <algorithm>
 #include <numeric>
+#include <omp.h>
 
 namespace model {
 
 DbNet::DbNet()
         : num_threads_(0),
-          env_(Ort::Env(ORT_LOGGING_LEVEL_ERROR, "DbNet")),
+          box_score_mode_(base::BoxScoreMode::kPolygon),
+          box_extract_mode_(base::BoxExtractMode::kContour),
+          env_(),
           session_options_(),
+          optimization_level_(ORT_ENABLE_ALL),
+          model_cache_dir_(),
           input_name_(),
           output_name_() {}
 
@@ -18,30 +25,171 @@ DbNet::~DbNet() {}
 void DbNet::SetNumThreads(int num_threads) {
     num_threads_ = num_threads;
     session_options_.SetIntraOpNumThreads(num_threads);
-    session_options_.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+    sessions_.SetNumThreads(num_threads);
+    optimization_level_ = GraphOptimizationLevel::ORT_ENABLE_EXTENDED;
+    session_options_.SetGraphOptimizationLevel(optimization_level_);
+}
+
+void DbNet::SetEnv(const std::shared_ptr<Ort::Env> &env, bool use_global_thread_pool) {
+    env_ = env;
+    if (use_global_thread_pool) {
+        session_options_.DisablePerSessionThreads();
+    }
+}
+
+void DbNet::SetNumSessions(int num_sessions) {
+    sessions_.SetSize(num_sessions);
+}
+
+void DbNet::SetModelCacheDir(const std::string &model_cache_dir) {
+    model_cache_dir_ = model_cache_dir;
+}
+
+void DbNet::SetPrepackedWeights(const std::shared_ptr<Ort::PrepackedWeightsContainer> &prepacked_weights) {
+    sessions_.SetPrepackedWeights(prepacked_weights);
+}
+
+void DbNet::SetBoxScoreMode(base::BoxScoreMode box_score_mode) {
+    box_score_mode_ = box_score_mode;
+}
+
+void DbNet::SetBoxExtractMode(base::BoxExtractMode box_extract_mode) {
+    box_extract_mode_ = box_extract_mode;
+}
+
+void DbNet::SetShapeBuckets(const std::vector<cv::Size> &shape_buckets) {
+    shape_buckets_ = shape_buckets;
+    // 按面积排序, 选择时取第一个能容纳的画布
+    std::sort(shape_buckets_.begin(), shape_buckets_.end(), [](const cv::Size &a, const cv::Size &b) {
+        return a.area() < b.area();
+    });
+    if (!sessions_.empty()) {
+        WarmupShapes(shape_buckets_);
+    }
+}
+
+void DbNet::SelectCanvas(base::ScaleParam &scale_param) const {
+    scale_param.canvas_width = scale_param.dest_width;
+    scale_param.canvas_height = scale_param.dest_height;
+    for (const auto &shape : shape_buckets_) {
+        if (shape.width >= scale_param.dest_width && shape.height >= scale_param.dest_height) {
+            scale_param.canvas_width = shape.width;
+            scale_param.canvas_height = shape.height;
+            return;
+        }
+    }
+}
+
+std::unique_ptr<DbNet::Context> DbNet::CreateContext() {
+    std::unique_ptr<Context> context(new Context());
+    context->session = sessions_.Next();
+    context->binding.reset(new Ort::IoBinding(*context->session));
+    return context;
+}
+
+void DbNet::WarmupShape(Context &context, int width, int height) {
+    float *input_data = context.input_buffer.Reshape({1, 3, height, width});
+    std::fill(input_data, input_data + context.input_buffer.size(), 0.0f);
+    context.output_buffer.Reshape({1, 1, height, width});
+
+    context.binding->BindInput(input_name_.c_str(), context.input_buffer.value());
+    context.binding->BindOutput(output_name_.c_str(), context.output_buffer.value());
+    context.session->Run(Ort::RunOptions{nullptr}, *context.binding);
+}
+
+void DbNet::WarmupShapes(const std::vector<cv::Size> &shapes) {
+    // 同时借出全部 Context, 保证每个 Session 都被预热; 共享模式下只有一个
+    std::vector<utils::ObjectPool<Context>::Lease> contexts;
+    for (int i = 0; i < sessions_.count(); ++i) {
+        contexts.emplace_back(contexts_.Acquire());
+        for (const auto &shape : shapes) {
+            WarmupShape(*contexts.back(), shape.width, shape.height);
+        }
+    }
 }
 
 void DbNet::Init(const std::string &model_path) {
-    session_ = std::make_shared<Ort::Session>(env_, model_path.c_str(), session_options_);
+    // Env 在进程内是单例, 延迟到此处创建, 以免先于 OcrLite 的全局线程池配置生效
+    if (!env_) {
+        env_ = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_ERROR, "DbNet");
+    }
+    sessions_.SetCacheDir(model_cache_dir_, optimization_level_);
+    sessions_.Init(*env_, model_path, session_options_);
+    InitContexts();
+}
 
-    utils::OcrUtils::GetInputName(session_, input_name_);
-    utils::OcrUtils::GetOutputName(session_, output_name_);
+void DbNet::Init(const base::ModelBuffer &model) {
+    if (!env_) {
+        env_ = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_ERROR, "DbNet");
+    }
+    sessions_.SetCacheDir(model_cache_dir_, optimization_level_);
+    sessions_.Init(*env_, model.data, model.length, session_options_);
+    InitContexts();
+}
+
+void DbNet::InitContexts() {
+    utils::OcrUtils::GetInputName(sessions_.Get(0), input_name_);
+    utils::OcrUtils::GetOutputName(sessions_.Get(0), output_name_);
+    // 每个 Context 绑定一个 Session, 池的容量即 Session 数, 为 0 时不限
+    contexts_.Reset([this]() { return CreateContext(); }, sessions_.size());
+    WarmupShapes(shape_buckets_);
+}
+
+void DbNet::Warmup(const std::vector<cv::Size> &sizes) {
+    // 换算成实际推理的画布尺寸并去重
+    std::vector<cv::Size> shapes;
+    for (const auto &size : sizes.empty() ? shape_buckets_ : sizes) {
+        base::ScaleParam scale_param = {};
+        scale_param.dest_width = size.width;
+        scale_param.dest_height = size.height;
+        SelectCanvas(scale_param);
+        cv::Size shape(scale_param.canvas_width, scale_param.canvas_height);
+        if (std::find(shapes.begin(), shapes.end(), shape) == shapes.end()) {
+            shapes.push_back(shape);
+        }
+    }
+    WarmupShapes(shapes);
 }
 
-std::vector<base::TextBox> DbNet::FindRsBoxes(const cv::Mat &feat, const cv::Mat &binary_feat, base::ScaleParam &scale_param, float box_score_threshold, float unclip_ratio) {
+std::vector<base::TextBox> DbNet::FindRsBoxes(Context &context, const cv::Mat &feat, base::ScaleParam &scale_param, float box_score_threshold, float unclip_ratio) {
     const float min_area = 3.0;
-    std::vector<base::TextBox> boxes;
     std::vector<std::vector<cv::Point>> contours;
-    findContours(binary_feat, contours, cv::RETR_LIST, cv::CHAIN_APPROX_SIMPLE);
+    bool use_components = box_extract_mode_ == base::BoxExtractMode::kComponent;
+    bool use_integral = !use_components && box_score_mode_ == base::BoxScoreMode::kIntegral;
+    const std::vector<base::TextComponent> &components = context.components;
+    const cv::Mat &integral_feat = context.integral_feat;
+    if (use_components) {
+        utils::OcrUtils::FindComponents(context.binary_feat, feat, context.components, &context.row_ranges);
+    } else {
+        utils::OcrUtils::FindBandContours(context.binary_feat, context.row_ranges, contours);
+    }
+    if (use_integral) {
+        cv::integral(feat, context.integral_feat, CV_64F);
+    }
+
+    // 各轮廓相互独立, 并行处理后按轮廓下标收集, 保证输出顺序与串行一致
+    int num_contours = use_components ? components.size() : contours.size();
+    std::vector<base::TextBox> candidates(num_contours);
+    std::vector<char> is_valid(num_contours, 0);
+    int num_threads = num_threads_ > 0 ? num_threads_ : omp_get_max_threads();
 
-    for (const auto &contour : contours) {
+#pragma omp parallel for schedule(dynamic, 16) num_threads(num_threads) if (num_contours > 64)
+    for (int i = 0; i < num_contours; ++i) {
+        const auto &contour = use_components ? components[i].points : contours[i];
         // 计算最小外接矩形的四个顶点
         float min_side_len, perimeter;
         std::vector<cv::Point> min_box = utils::OcrUtils::GetMinBoxes(contour, min_side_len, perimeter);
         if (min_side_len < min_area) continue;
 
         // 计算box得分
-        float score = utils::OcrUtils::BoxScoreFast(feat, contour);
+        float score = 0.0f;
+        if (use_components) {
+            score = components[i].score_sum / components[i].span_area;
+        } else if (use_integral) {
+            score = utils::OcrUtils::BoxScoreIntegral(integral_feat, contour);
+        } else {
+            score = utils::OcrUtils::BoxScoreFast(feat, contour);
+        }
         if (score < box_score_threshold) continue;
 
         // 截取 box
@@ -55,37 +203,58 @@ std::vector<base::TextBox> DbNet::FindRsBoxes(const cv::Mat &feat, const cv::Mat
             point.y = point.y / scale_param.ratio_h;
             point.y = std::min(std::max(0, point.y), scale_param.src_height);
         }
-        boxes.emplace_back(base::TextBox{clip_min_box, score});
+        candidates[i] = base::TextBox{clip_min_box, score};
+        is_valid[i] = 1;
+    }
+
+    // 输出按各区域首个像素的光栅顺序, 即自上而下: 轮廓与原先一样逆序输出, 连通域本身已是该顺序
+    std::vector<base::TextBox> boxes;
+    for (int k = 0; k < num_contours; ++k) {
+        int i = use_components ? k : num_contours - 1 - k;
+        if (is_valid[i]) {
+            boxes.emplace_back(std::move(candidates[i]));
+        }
     }
-    reverse(boxes.begin(), boxes.end());
     return boxes;
 }
 
 std::vector<base::TextBox> DbNet::GetTextBoxes(cv::Mat &src, base::ScaleParam &scale_param, float box_score_threshold, float box_threshold, float unclip_ratio) {
-    cv::Mat src_resize;
-    cv::resize(src, src_resize, cv::Size(scale_param.dest_width, scale_param.dest_height));
+    int rows = scale_param.dest_height;
+    int cols = scale_param.dest_width;
+    SelectCanvas(scale_param);
+    int canvas_rows = scale_param.canvas_height;
+    int canvas_cols = scale_param.canvas_width;
+
+    utils::ObjectPool<Context>::Lease context = contexts_.Acquire();
+    utils::TensorBuffer &input_buffer = context->input_buffer;
+    utils::TensorBuffer &output_buffer = context->output_buffer;
 
-    // 预处理
-    auto input_data = utils::OcrUtils::SubstractMeanNormalize(src_resize, mean_, norm_);
-    std::array<int64_t, 4> input_shape{1, src_resize.channels(), src_resize.rows, src_resize.cols};
-    auto memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+    // 预处理: 缩放、BGR 转 RGB、归一化一次完成, 直接写入复用的输入缓冲区, 画布多余部分填充白色
+    float *input_data = input_buffer.Reshape({1, 3, canvas_rows, canvas_cols});
+    utils::OcrUtils::ResizeNormalize(src, cols, rows, canvas_cols, canvas_rows, mean_, norm_, true, cv::Scalar(255, 255, 255), input_data);
 
-    // 创建输入tensor
-    Ort::Value input_tensor = Ort::Value::CreateTensor<float>(memory_info, input_data.data(), input_data.size(), input_shape.data(), input_shape.size());
+    // 输出形状为 [1, 1, H, W], 预先分配输出缓冲区
+    float *output_data = output_buffer.Reshape({1, 1, canvas_rows, canvas_cols});
 
-    std::vector<const char*> input_names = {input_name_.c_str()};
-    std::vector<const char*> output_names = {output_name_.c_str()};
+    context->binding->BindInput(input_name_.c_str(), input_buffer.value());
+    context->binding->BindOutput(output_name_.c_str(), output_buffer.value());
+    context->session->Run(Ort::RunOptions{nullptr}, *context->binding);
 
-    // 获取输出tensor
-    auto output_tensor = session_->Run(Ort::RunOptions{nullptr}, input_names.data(), &input_tensor, input_names.size(), output_names.data(), output_names.size());
+    // 构建特征图
+    // 只取图像所在的区域
+    cv::Mat feat = cv::Mat(canvas_rows, canvas_cols, CV_32FC1, output_data)(cv::Rect(0, 0, cols, rows));
 
-    // 获取输出tensor的数据, 构建特征图
-    float* output_data = output_tensor.front().GetTensorMutableData<float>();
-    cv::Mat feat(src_resize.rows, src_resize.cols, CV_32FC1, output_data);
-    cv::Mat binary_feat = feat > box_threshold;
+    // 二值化的同时记录每行前景的列范围, 后续只处理非空的行带
+    context->binary_feat.create(rows, cols, CV_8UC1);
+    context->row_ranges.resize(rows);
+    for (int y = 0; y < rows; ++y) {
+        int first, last;
+        int count = utils::SimdUtils::ThresholdRow(feat.ptr<float>(y), cols, box_threshold, context->binary_feat.ptr<uchar>(y), first, last);
+        context->row_ranges[y] = count > 0 ? cv::Range(first, last + 1) : cv::Range(0, 0);
+    }
 
     // 查找文本框
-    return FindRsBoxes(feat, binary_feat, scale_param, box_score_threshold, unclip_ratio);
+    return FindRsBoxes(*context, feat, scale_param, box_score_threshold, unclip_ratio);
 }
 
 } // namespace model
\ No newline at end of file
@@ -4,50 +4,423 @@
 #include "utils/image_utils.h"
 #include "utils/time_utils.h"
 
+#include <algorithm>
 #include <fstream>
+#include <iterator>
+#include <stdexcept>
 
 namespace model {
 
+namespace {
+
+// 填充后长边的缩放目标: 长边不超过 max_side_len 时不缩放
+int GetDetResizeLen(const cv::Size &src_size, int padding, int max_side_len) {
+    int max_side = std::max(src_size.width, src_size.height);
+    int resize = max_side_len <= 0 || max_side_len >= max_side ? max_side : max_side_len;
+    return resize + 2 * padding;
+}
+
+// 未指定代表尺寸时的常见来源: 手机拍照 4:3, A4 300dpi 扫描, 1080p 截图, 横竖两个方向
+const cv::Size kDetWarmupImageSizes[] = {
+    cv::Size(4032, 3024), cv::Size(3024, 4032),
+    cv::Size(2480, 3508), cv::Size(3508, 2480),
+    cv::Size(1920, 1080), cv::Size(1080, 1920),
+};
+
+} // namespace
+
+void OcrLite::InitEnv() {
+    // 三个模型共用一个 Env
+    if (use_global_thread_pool_) {
+        const OrtApi &api = Ort::GetApi();
+        OrtThreadingOptions *threading_options = nullptr;
+        Ort::ThrowOnError(api.CreateThreadingOptions(&threading_options));
+        Ort::ThrowOnError(api.SetGlobalIntraOpNumThreads(threading_options, global_intra_op_threads_));
+        Ort::ThrowOnError(api.SetGlobalInterOpNumThreads(threading_options, global_inter_op_threads_));
+        Ort::ThrowOnError(api.SetGlobalSpinControl(threading_options, allow_spinning_ ? 1 : 0));
+        env_ = std::make_shared<Ort::Env>(threading_options, ORT_LOGGING_LEVEL_ERROR, "OcrLite");
+        api.ReleaseThreadingOptions(threading_options);
+    } else {
+        env_ = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_ERROR, "OcrLite");
+    }
+    db_net_.SetEnv(env_, use_global_thread_pool_);
+    angle_net_.SetEnv(env_, use_global_thread_pool_);
+    crnn_net_.SetEnv(env_, use_global_thread_pool_);
+}
+
 void OcrLite::Init(const std::string &det_path, const std::string &cls_path, const std::string &rec_path, const std::string &keys_path) {
+    if (map_models_) {
+        if (det_file_.Open(det_path) && cls_file_.Open(cls_path) && rec_file_.Open(rec_path)) {
+            Init(base::ModelBuffer{det_file_.data(), det_file_.size()},
+                 base::ModelBuffer{cls_file_.data(), cls_file_.size()},
+                 base::ModelBuffer{rec_file_.data(), rec_file_.size()}, keys_path);
+            return;
+        }
+        det_file_.Close();
+        cls_file_.Close();
+        rec_file_.Close();
+    }
+
+    InitEnv();
     db_net_.Init(det_path);
     angle_net_.Init(cls_path);
     crnn_net_.Init(rec_path, keys_path);
 }
 
+void OcrLite::Init(const base::ModelBuffer &det_model, const base::ModelBuffer &cls_model, const base::ModelBuffer &rec_model, const std::string &keys_path) {
+    InitEnv();
+    db_net_.Init(det_model);
+    angle_net_.Init(cls_model);
+    crnn_net_.Init(rec_model, keys_path);
+}
+
+void OcrLite::SetPrepackedWeights(const std::shared_ptr<Ort::PrepackedWeightsContainer> &prepacked_weights) {
+    db_net_.SetPrepackedWeights(prepacked_weights);
+    angle_net_.SetPrepackedWeights(prepacked_weights);
+    crnn_net_.SetPrepackedWeights(prepacked_weights);
+}
+
+base::WarmupResult OcrLite::Warmup(const std::vector<cv::Size> &det_sizes, const std::vector<int> &rec_widths) {
+    base::WarmupResult result;
+    double start_time = utils::TimeUtils::now();
+    db_net_.Warmup(det_sizes);
+    double det_end_time = utils::TimeUtils::now();
+    angle_net_.Warmup();
+    double cls_end_time = utils::TimeUtils::now();
+    crnn_net_.Warmup(rec_widths);
+    double end_time = utils::TimeUtils::now();
+
+    result.det_time = det_end_time - start_time;
+    result.cls_time = cls_end_time - det_end_time;
+    result.rec_time = end_time - cls_end_time;
+    result.full_time = end_time - start_time;
+    return result;
+}
+
+std::vector<cv::Size> OcrLite::GetDetWarmupSizes(int max_side_len, int padding, const std::vector<cv::Size> &image_sizes) {
+    std::vector<cv::Size> src_sizes = image_sizes;
+    if (src_sizes.empty()) {
+        src_sizes.assign(std::begin(kDetWarmupImageSizes), std::end(kDetWarmupImageSizes));
+    }
+    // 与 MakeTask 相同的计算: 先填充, 再由 GetScaleParam 缩放并向下取整到 32 的倍数
+    int offset = std::max(0, padding);
+    std::vector<cv::Size> sizes;
+    for (const cv::Size &src_size : src_sizes) {
+        if (src_size.width <= 0 || src_size.height <= 0) continue;
+        cv::Size padded_size(src_size.width + 2 * offset, src_size.height + 2 * offset);
+        base::ScaleParam scale_param = utils::ImageUtils::GetScaleParam(padded_size, GetDetResizeLen(src_size, padding, max_side_len));
+        cv::Size size(scale_param.dest_width, scale_param.dest_height);
+        if (std::find(sizes.begin(), sizes.end(), size) == sizes.end()) {
+            sizes.push_back(size);
+        }
+    }
+    return sizes;
+}
+
+void OcrLite::SetModelCacheDir(const std::string &model_cache_dir) {
+    db_net_.SetModelCacheDir(model_cache_dir);
+    angle_net_.SetModelCacheDir(model_cache_dir);
+    crnn_net_.SetModelCacheDir(model_cache_dir);
+}
+
 void OcrLite::SetNumThreads(int num_threads) {
     angle_net_.SetNumThreads(num_threads);
     db_net_.SetNumThreads(num_threads);
     crnn_net_.SetNumThreads(num_threads);
 }
 
+void OcrLite::SetGlobalThreadPool(int intra_op_threads, int inter_op_threads, bool allow_spinning) {
+    use_global_thread_pool_ = true;
+    global_intra_op_threads_ = std::max(0, intra_op_threads);
+    global_inter_op_threads_ = std::max(1, inter_op_threads);
+    allow_spinning_ = allow_spinning;
+}
+
+void OcrLite::SetNumSessions(int det_sessions, int cls_sessions, int rec_sessions) {
+    db_net_.SetNumSessions(det_sessions);
+    angle_net_.SetNumSessions(cls_sessions);
+    crnn_net_.SetNumSessions(rec_sessions);
+}
+
+void OcrLite::SetClsBatchSize(int batch_size) {
+    angle_net_.SetBatchSize(batch_size);
+}
+
+void OcrLite::SetRecBatchSize(int batch_size) {
+    crnn_net_.SetBatchSize(batch_size);
+}
+
+void OcrLite::SetRecWidthBuckets(const std::vector<int> &width_buckets) {
+    crnn_net_.SetWidthBuckets(width_buckets);
+}
+
+void OcrLite::SetRecWidthAlign(int width_align) {
+    crnn_net_.SetWidthAlign(width_align);
+}
+
+void OcrLite::SetCalCharScores(bool cal_char_scores) {
+    crnn_net_.SetCalCharScores(cal_char_scores);
+}
+
+void OcrLite::SetBoxScoreMode(base::BoxScoreMode box_score_mode) {
+    db_net_.SetBoxScoreMode(box_score_mode);
+}
+
+void OcrLite::SetBoxExtractMode(base::BoxExtractMode box_extract_mode) {
+    db_net_.SetBoxExtractMode(box_extract_mode);
+}
+
+void OcrLite::SetDetShapeBuckets(const std::vector<cv::Size> &shape_buckets) {
+    db_net_.SetShapeBuckets(shape_buckets);
+}
+
+void OcrLite::SetDetTiling(int tile_size, int tile_overlap) {
+    det_tile_size_ = std::max(0, tile_size);
+    det_tile_overlap_ = std::max(0, tile_overlap);
+}
+
 base::OcrResult OcrLite::Process(const std::string &image_dir, const std::string &image_name, int padding, int max_side_len, float box_score_threshold, float box_threshold, float unclip_ratio, bool cal_angle, bool cal_most_angle) {
     std::string image_path = utils::FileUtils::JoinPath(image_dir, image_name);
 
-    cv::Mat src_bgr = cv::imread(image_path, cv::IMREAD_COLOR); // BGR image
-    cv::Mat src_rgb;
-    cv::cvtColor(src_bgr, src_rgb, cv::COLOR_BGR2RGB); // RGB image
+    // 保持 BGR 格式, 通道交换在各网络的预处理中完成
+    cv::Mat src_bgr = cv::imread(image_path, cv::IMREAD_COLOR);
 
-    // 图像预处理
-    int max_side = std::max(src_rgb.cols, src_rgb.rows);
-    int resize = max_side_len <= 0 || max_side_len >= max_side ? max_side : max_side_len;
-    resize += 2 * padding;
-    cv::Rect padding_rect(padding, padding, src_rgb.cols, src_rgb.rows);
-    cv::Mat src_padding = MakePadding(src_rgb, padding);
-    base::ScaleParam scale_param = utils::ImageUtils::GetScaleParam(src_padding, resize);
-
-    return process(image_dir, image_name, src_padding, padding_rect, scale_param, box_score_threshold, box_threshold, unclip_ratio, cal_angle, cal_most_angle);
+    OcrTaskPtr task = MakeTask(image_dir, image_name, src_bgr, base::ColorOrder::kBgr, padding, max_side_len, box_score_threshold, box_threshold, unclip_ratio, cal_angle, cal_most_angle);
+    return process(*task);
 }
 
 base::OcrResult OcrLite::Process(cv::Mat &src, int padding, int max_side_len, float box_score_threshold, float box_threshold, float unclip_ratio, bool cal_angle, bool cal_most_angle) {
-    int max_side = std::max(src.cols, src.rows);
-    int resize = max_side_len <= 0 || max_side_len >= max_side ? max_side : max_side_len;
-    resize += 2 * padding;
-    cv::Rect padding_rect(padding, padding, src.cols, src.rows);
-    cv::Mat src_padding = MakePadding(src, padding);
-    base::ScaleParam scale_param = utils::ImageUtils::GetScaleParam(src_padding, resize);
+    // 以任务编号命名, 并发调用时输出文件不会重名
+    OcrTaskPtr task = MakeTask(output_path_, "", src, input_color_order_, padding, max_side_len, box_score_threshold, box_threshold, unclip_ratio, cal_angle, cal_most_angle);
+    task->image_name = "image" + std::to_string(task->id);
+    return process(*task);
+}
+
+base::OcrResult OcrLite::Process(cv::Mat &src, const std::vector<std::vector<cv::Point>> &regions, base::RoiMode roi_mode, int padding, int max_side_len, float box_score_threshold, float box_threshold, float unclip_ratio, bool cal_angle, bool cal_most_angle) {
+    OcrTaskPtr task = MakeTask(output_path_, "", src, input_color_order_, padding, max_side_len, box_score_threshold, box_threshold, unclip_ratio, cal_angle, cal_most_angle);
+    task->image_name = "image" + std::to_string(task->id);
+
+    // 区域换算到填充后的坐标, 并裁剪到图像范围内
+    int offset = std::max(0, padding);
+    task->has_regions = true;
+    task->roi_mode = roi_mode;
+    for (const auto &region : regions) {
+        if (region.size() != 4) continue;
+        std::vector<cv::Point> points;
+        for (const auto &point : region) {
+            points.emplace_back(std::min(std::max(0, point.x), src.cols) + offset, std::min(std::max(0, point.y), src.rows) + offset);
+        }
+        task->regions.emplace_back(points);
+    }
+    return process(*task);
+}
+
+base::DetResult OcrLite::DetectBoxes(cv::Mat &src, int padding, int max_side_len, float box_score_threshold, float box_threshold, float unclip_ratio) {
+    OcrTaskPtr task = MakeTask(output_path_, "", src, input_color_order_, padding, max_side_len, box_score_threshold, box_threshold, unclip_ratio, false, false);
+    if (!task->error.empty()) {
+        throw std::invalid_argument(task->error);
+    }
+    Detect(*task);
+
+    // 去掉填充, 裁剪到原图范围内
+    const cv::Rect &original_rect = task->original_rect;
+    for (auto &box : task->boxes) {
+        for (auto &point : box.points) {
+            point.x = std::min(std::max(0, point.x - original_rect.x), original_rect.width);
+            point.y = std::min(std::max(0, point.y - original_rect.y), original_rect.height);
+        }
+    }
+    return base::DetResult{std::move(task->boxes), task->det_time};
+}
+
+std::vector<base::TextLine> OcrLite::RecognizeLines(const std::vector<cv::Mat> &images, bool cal_angle, bool cal_most_angle, std::vector<base::Angle> *angles) {
+    // 与 Process 等接口共用任务编号, 并发调用时调试输出的文件名不会冲突
+    std::string image_name = "image" + std::to_string(next_task_id_++);
+
+    // 各网络按 BGR 处理, RGB 输入先转换; 不修改调用方的输入
+    std::vector<cv::Mat> line_images(images);
+    if (input_color_order_ == base::ColorOrder::kRgb) {
+        for (size_t i = 0; i < line_images.size(); ++i) {
+            if (!images[i].empty()) {
+                cv::Mat line_bgr;
+                cv::cvtColor(images[i], line_bgr, cv::COLOR_RGB2BGR);
+                line_images[i] = line_bgr;
+            }
+        }
+    }
+    std::vector<base::Angle> line_angles = angle_net_.GetAngles(line_images, output_path_, image_name, cal_angle, cal_most_angle);
+
+    // 只复制需要旋转的图像
+    for (size_t i = 0; i < line_images.size(); ++i) {
+        if (line_angles[i].index == 0) {
+            cv::Mat rotated;
+            flip(line_images[i], rotated, -1);
+            line_images[i] = rotated;
+        }
+    }
+    std::vector<base::TextLine> text_lines = crnn_net_.GetTextLines(line_images, output_path_, image_name);
 
-    std::string image_name = "image" + std::to_string(utils::TimeUtils::now());
-    return process(output_path_, image_name, src_padding, padding_rect, scale_param, box_score_threshold, box_threshold, unclip_ratio, cal_angle, cal_most_angle);
+    if (angles) {
+        *angles = std::move(line_angles);
+    }
+    return text_lines;
+}
+
+void OcrLite::StartPipeline(int queue_capacity) {
+    if (is_pipeline_running_) return;
+
+    size_t capacity = std::max(1, queue_capacity);
+    det_queue_.reset(new utils::BlockingQueue<OcrTaskPtr>(capacity));
+    cls_queue_.reset(new utils::BlockingQueue<OcrTaskPtr>(capacity));
+    rec_queue_.reset(new utils::BlockingQueue<OcrTaskPtr>(capacity));
+    // 结果队列沿用上一次运行的, 未取出的结果不会丢失
+    if (result_queue_) {
+        result_queue_->Reopen();
+    } else {
+        result_queue_.reset(new utils::BlockingQueue<TaskResult>());
+    }
+
+    is_pipeline_running_ = true;
+    pipeline_threads_.emplace_back(&OcrLite::DetectLoop, this);
+    pipeline_threads_.emplace_back(&OcrLite::ClassifyLoop, this);
+    pipeline_threads_.emplace_back(&OcrLite::RecognizeLoop, this);
+}
+
+void OcrLite::StopPipeline() {
+    if (!is_pipeline_running_) return;
+
+    // 关闭输入队列后, 各阶段处理完剩余任务依次退出
+    det_queue_->Close();
+    for (auto &thread : pipeline_threads_) {
+        thread.join();
+    }
+    pipeline_threads_.clear();
+    is_pipeline_running_ = false;
+}
+
+int64_t OcrLite::Submit(const std::string &image_dir, const std::string &image_name, int padding, int max_side_len, float box_score_threshold, float box_threshold, float unclip_ratio, bool cal_angle, bool cal_most_angle) {
+    std::string image_path = utils::FileUtils::JoinPath(image_dir, image_name);
+
+    // 保持 BGR 格式, 通道交换在各网络的预处理中完成
+    cv::Mat src_bgr = cv::imread(image_path, cv::IMREAD_COLOR);
+
+    OcrTaskPtr task = MakeTask(image_dir, image_name, src_bgr, base::ColorOrder::kBgr, padding, max_side_len, box_score_threshold, box_threshold, unclip_ratio, cal_angle, cal_most_angle);
+    int64_t task_id = task->id;
+    if (!is_pipeline_running_ || !det_queue_->Push(std::move(task))) {
+        return -1;
+    }
+    return task_id;
+}
+
+int64_t OcrLite::Submit(cv::Mat &src, int padding, int max_side_len, float box_score_threshold, float box_threshold, float unclip_ratio, bool cal_angle, bool cal_most_angle) {
+    OcrTaskPtr task = MakeTask(output_path_, "", src, input_color_order_, padding, max_side_len, box_score_threshold, box_threshold, unclip_ratio, cal_angle, cal_most_angle);
+    task->image_name = "image" + std::to_string(task->id);
+    // 不填充且无需转换时 task->src 与调用方共享像素, 复制一份以免排队期间被修改
+    if (task->src.data == src.data) {
+        task->src = task->src.clone();
+    }
+    int64_t task_id = task->id;
+    if (!is_pipeline_running_ || !det_queue_->Push(std::move(task))) {
+        return -1;
+    }
+    return task_id;
+}
+
+bool OcrLite::Collect(int64_t &task_id, base::OcrResult &result) {
+    if (!result_queue_) return false;
+
+    TaskResult task_result;
+    if (!result_queue_->Pop(task_result)) {
+        return false;
+    }
+    task_id = task_result.first;
+    result = std::move(task_result.second);
+    return true;
+}
+
+// 各阶段的异常只影响当前任务: 记录错误后任务继续向后传递, 保证结果仍按提交顺序输出
+void OcrLite::DetectLoop() {
+    OcrTaskPtr task;
+    while (det_queue_->Pop(task)) {
+        RunStage(*task, &OcrLite::Detect);
+        cls_queue_->Push(std::move(task));
+    }
+    cls_queue_->Close();
+}
+
+void OcrLite::ClassifyLoop() {
+    OcrTaskPtr task;
+    while (cls_queue_->Pop(task)) {
+        RunStage(*task, &OcrLite::Classify);
+        rec_queue_->Push(std::move(task));
+    }
+    rec_queue_->Close();
+}
+
+void OcrLite::RecognizeLoop() {
+    OcrTaskPtr task;
+    while (rec_queue_->Pop(task)) {
+        RunStage(*task, &OcrLite::Recognize);
+        base::OcrResult result;
+        if (task->error.empty()) {
+            try {
+                result = MakeResult(*task);
+            } catch (const std::exception &e) {
+                task->error = e.what();
+            }
+        }
+        result.error = task->error;
+        int64_t task_id = task->id;
+        result_queue_->Push(TaskResult(task_id, std::move(result)));
+    }
+    result_queue_->Close();
+}
+
+void OcrLite::RunStage(OcrTask &task, void (OcrLite::*stage)(OcrTask &)) {
+    if (!task.error.empty()) return;
+    try {
+        (this->*stage)(task);
+    } catch (const std::exception &e) {
+        task.error = e.what();
+    }
+}
+
+OcrLite::OcrTaskPtr OcrLite::MakeTask(const std::string &image_dir, const std::string &image_name, cv::Mat &src, base::ColorOrder color_order, int padding, int max_side_len, float box_score_threshold, float box_threshold, float unclip_ratio, bool cal_angle, bool cal_most_angle) {
+    OcrTaskPtr task(new OcrTask());
+    task->id = next_task_id_++;
+    task->image_dir = image_dir;
+    task->image_name = image_name;
+    if (src.empty()) {
+        task->error = "empty image: " + utils::FileUtils::JoinPath(image_dir, image_name);
+        return task;
+    }
+
+    // 图像预处理
+    int resize = GetDetResizeLen(cv::Size(src.cols, src.rows), padding, max_side_len);
+    task->original_rect = cv::Rect(padding, padding, src.cols, src.rows);
+    task->src = MakePadding(src, padding);
+    if (color_order == base::ColorOrder::kRgb) {
+        // 填充后的图像是新分配的, 原地转换; 否则 task->src 与 src 共享像素, 需转换到新图像
+        if (task->src.data != src.data) {
+            cv::cvtColor(task->src, task->src, cv::COLOR_RGB2BGR);
+        } else {
+            cv::Mat src_bgr;
+            cv::cvtColor(src, src_bgr, cv::COLOR_RGB2BGR);
+            task->src = src_bgr;
+        }
+    }
+    task->scale_param = utils::ImageUtils::GetScaleParam(task->src, resize);
+    task->det_scale = static_cast<float>(resize) / std::max(task->src.cols, task->src.rows);
+
+    task->box_score_threshold = box_score_threshold;
+    task->box_threshold = box_threshold;
+    task->unclip_ratio = unclip_ratio;
+    task->cal_angle = cal_angle;
+    task->cal_most_angle = cal_most_angle;
+    task->max_side_len = max_side_len;
+    task->has_regions = false;
+    task->roi_mode = base::RoiMode::kSkipDetection;
+    return task;
 }
 
 cv::Mat OcrLite::MakePadding(cv::Mat &src, const int padding, const cv::Scalar &padding_value) {
@@ -74,35 +447,112 @@ std::vector<cv::Mat> OcrLite::GetBoxImages(const cv::Mat &src, std::vector<base:
     return box_images;
 }
 
-base::OcrResult OcrLite::process(const std::string &image_dir, const std::string &image_name, cv::Mat &src, cv::Rect &orignal_rect, base::ScaleParam &scale_param, float box_score_threshold, float box_threshold, float unclip_ratio, bool cal_angle, bool cal_most_angle) {
-    cv::Mat text_box_padding_image = src.clone();
-    int thickness = utils::ImageUtils::GetThickness(src);
+base::OcrResult OcrLite::process(OcrTask &task) {
+    if (!task.error.empty()) {
+        throw std::invalid_argument(task.error);
+    }
+    Detect(task);
+    Classify(task);
+    Recognize(task);
+    return MakeResult(task);
+}
 
+void OcrLite::Detect(OcrTask &task) {
     // 文本检测
-    double det_start = utils::TimeUtils::now();
-    std::vector<base::TextBox> boxes = db_net_.GetTextBoxes(src, scale_param, box_score_threshold, box_threshold, unclip_ratio);
-    double det_end = utils::TimeUtils::now();
-    double det_time = det_end - det_start;
+    task.start_time = utils::TimeUtils::now();
+    int det_side = std::max(task.scale_param.dest_width, task.scale_param.dest_height);
+    if (task.has_regions) {
+        task.boxes = DetectRegions(task);
+    } else if (det_tile_size_ > 0 && det_side > det_tile_size_) {
+        task.boxes = DetectTiles(task);
+    } else {
+        task.boxes = db_net_.GetTextBoxes(task.src, task.scale_param, task.box_score_threshold, task.box_threshold, task.unclip_ratio);
+    }
+    task.det_time = utils::TimeUtils::now() - task.start_time;
     // TODO: LOG_INFO det
+}
 
-    utils::OcrUtils::DrawTextBoxes(text_box_padding_image, boxes, thickness);
-    
+std::vector<base::TextBox> OcrLite::DetectRect(const cv::Mat &src, const cv::Rect &rect, float scale, float box_score_threshold, float box_threshold, float unclip_ratio) {
+    cv::Mat roi = src(rect);
+    base::ScaleParam scale_param = utils::ImageUtils::GetScaleParam(roi, scale);
+    std::vector<base::TextBox> boxes = db_net_.GetTextBoxes(roi, scale_param, box_score_threshold, box_threshold, unclip_ratio);
+    for (auto &box : boxes) {
+        for (auto &point : box.points) {
+            point += rect.tl();
+        }
+    }
+    return boxes;
+}
+
+std::vector<base::TextBox> OcrLite::DetectTiles(OcrTask &task) {
+    // 分块大小以检测输入像素计, 换算回原图像素
+    float scale = task.det_scale;
+    int tile_size = std::max(32, static_cast<int>(det_tile_size_ / scale));
+    int tile_overlap = static_cast<int>(det_tile_overlap_ / scale);
+    std::vector<cv::Rect> tile_rects = utils::OcrUtils::GetTileRects(task.src.size(), tile_size, tile_overlap);
+
+    // 逐块执行, 单块推理本身已使用 intra-op 线程. 每块的 DetectRect 各自从池中借用检测 Context, 推理结束即归还,
+    // 不保证拿到同一份缓冲区; 单次调用任一时刻只持有一块的输入输出, 内存峰值随分块大小而非整图大小变化
+    std::vector<std::vector<base::TextBox>> tile_boxes(tile_rects.size());
+    for (size_t i = 0; i < tile_rects.size(); ++i) {
+        tile_boxes[i] = DetectRect(task.src, tile_rects[i], scale, task.box_score_threshold, task.box_threshold, task.unclip_ratio);
+    }
+    return utils::OcrUtils::MergeTileBoxes(tile_boxes, tile_rects, task.src.size());
+}
+
+std::vector<base::TextBox> OcrLite::DetectRegions(OcrTask &task) {
+    std::vector<base::TextBox> boxes;
+    for (const auto &region : task.regions) {
+        cv::Rect rect = cv::boundingRect(region) & cv::Rect(0, 0, task.src.cols, task.src.rows);
+        // 退化的区域无法裁剪
+        if (rect.width < 2 || rect.height < 2) continue;
+
+        if (task.roi_mode == base::RoiMode::kSkipDetection) {
+            boxes.push_back(base::TextBox{region, 1.0f});
+            continue;
+        }
+
+        int max_side = std::max(rect.width, rect.height);
+        float scale = task.max_side_len <= 0 || task.max_side_len >= max_side ? 1.0f : static_cast<float>(task.max_side_len) / max_side;
+        std::vector<base::TextBox> region_boxes = DetectRect(task.src, rect, scale, task.box_score_threshold, task.box_threshold, task.unclip_ratio);
+        boxes.insert(boxes.end(), region_boxes.begin(), region_boxes.end());
+    }
+    return boxes;
+}
+
+void OcrLite::Classify(OcrTask &task) {
     // 角度检测
-    std::vector<cv::Mat> box_images = GetBoxImages(src, boxes, image_dir, image_name);
-    std::vector<base::Angle> angles = angle_net_.GetAngles(box_images, image_dir, image_name, cal_angle, cal_most_angle);
+    task.box_images = GetBoxImages(task.src, task.boxes, task.image_dir, task.image_name);
+    task.angles = angle_net_.GetAngles(task.box_images, task.image_dir, task.image_name, task.cal_angle, task.cal_most_angle);
     // TODO: LOG_INFO cls
     // 根据角度旋转文本框
-    for (size_t i = 0; i < boxes.size(); ++i) {
-        if (angles[i].index == 0) {
+    for (size_t i = 0; i < task.boxes.size(); ++i) {
+        if (task.angles[i].index == 0) {
             // 旋转 180 度
-            flip(box_images[i], box_images[i], 0);
-            flip(box_images[i], box_images[i], 1);
+            flip(task.box_images[i], task.box_images[i], 0);
+            flip(task.box_images[i], task.box_images[i], 1);
         }
     }
+}
 
+void OcrLite::Recognize(OcrTask &task) {
     // 文本识别
-    std::vector<base::TextLine> text_lines = crnn_net_.GetTextLines(box_images, image_dir, image_name);
+    task.text_lines = crnn_net_.GetTextLines(task.box_images, task.image_dir, task.image_name);
     // TODO: LOG_INFO rec
+}
+
+base::OcrResult OcrLite::MakeResult(OcrTask &task) {
+    const std::string &image_dir = task.image_dir;
+    const std::string &image_name = task.image_name;
+    const cv::Rect &orignal_rect = task.original_rect;
+    std::vector<base::TextBox> &boxes = task.boxes;
+    std::vector<cv::Mat> &box_images = task.box_images;
+    std::vector<base::Angle> &angles = task.angles;
+    std::vector<base::TextLine> &text_lines = task.text_lines;
+
+    cv::Mat text_box_padding_image = task.src.clone();
+    int thickness = utils::ImageUtils::GetThickness(task.src);
+    utils::OcrUtils::DrawTextBoxes(text_box_padding_image, boxes, thickness);
 
     // 合并结果
     std::vector<base::TextBlock> text_blocks;
@@ -128,16 +578,15 @@ base::OcrResult OcrLite::process(const std::string &image_dir, const std::string
             }
         );
     }
-    double full_time = utils::TimeUtils::now() - det_start;
+    double full_time = utils::TimeUtils::now() - task.start_time;
 
-    // 修剪图片至原始大小，并转换为BGR格式
-    cv::Mat rgb_box_image, text_box_image;
+    // 修剪图片至原始大小
+    cv::Mat text_box_image;
     if (orignal_rect.x > 0 && orignal_rect.y > 0) {
-        rgb_box_image = text_box_padding_image(orignal_rect).clone();
+        text_box_image = text_box_padding_image(orignal_rect).clone();
     } else {
-        rgb_box_image = text_box_padding_image;
+        text_box_image = text_box_padding_image;
     }
-    cv::cvtColor(rgb_box_image, text_box_image, cv::COLOR_RGB2BGR);
         
     std::string str_result;
     for (const auto &block : text_blocks) {
@@ -171,7 +620,7 @@ base::OcrResult OcrLite::process(const std::string &image_dir, const std::string
     return base::OcrResult{
         text_blocks,
         text_box_image,
-        det_time,
+        task.det_time,
         str_result,
         full_time
     };
@@ -2,6 +2,9 @@
 
 #include <iostream>
 #include <experimental/filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 namespace fs = std::experimental::filesystem;
 
@@ -30,4 +33,44 @@ void FileUtils::ListDir(const std::string &path, std::vector<std::string> &files
     }
 }
 
+MappedFile::MappedFile() : data_(nullptr), size_(0) {}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const std::string &path) {
+    Close();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "MappedFile open error: " << path << std::endl;
+        return false;
+    }
+    struct stat buffer;
+    if (fstat(fd, &buffer) != 0 || buffer.st_size <= 0) {
+        std::cerr << "MappedFile stat error: " << path << std::endl;
+        close(fd);
+        return false;
+    }
+
+    // 映射建立后即可关闭文件描述符
+    void *data = mmap(nullptr, buffer.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "MappedFile mmap error: " << path << std::endl;
+        return false;
+    }
+    data_ = data;
+    size_ = buffer.st_size;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data_) {
+        munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
 } // namespace utils
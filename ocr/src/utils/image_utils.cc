@@ -71,8 +71,16 @@ int ImageUtils::GetThickness(const cv::Mat &box_image) {
 }
 
 base::ScaleParam ImageUtils::GetScaleParam(const cv::Mat &src, float scale) {
-    int src_width = src.cols;
-    int src_height = src.rows;
+    return GetScaleParam(cv::Size(src.cols, src.rows), scale);
+}
+
+base::ScaleParam ImageUtils::GetScaleParam(const cv::Mat &src, int target_max_side_len) {
+    return GetScaleParam(cv::Size(src.cols, src.rows), target_max_side_len);
+}
+
+base::ScaleParam ImageUtils::GetScaleParam(const cv::Size &src_size, float scale) {
+    int src_width = src_size.width;
+    int src_height = src_size.height;
     int dest_width = static_cast<int>(src_width * scale);
     if (dest_width % 32 != 0) {
         dest_width = (dest_width / 32) * 32;
@@ -86,13 +94,13 @@ base::ScaleParam ImageUtils::GetScaleParam(const cv::Mat &src, float scale) {
 
     float scale_w = static_cast<float>(dest_width) / src_width;
     float scale_h = static_cast<float>(dest_height) / src_height;
-    return {src_width, src_height, dest_width, dest_height, scale_w, scale_h};
+    return {src_width, src_height, dest_width, dest_height, scale_w, scale_h, dest_width, dest_height};
 }
 
-base::ScaleParam ImageUtils::GetScaleParam(const cv::Mat &src, int target_max_side_len) {
-    int max_side = std::max(src.cols, src.rows);
+base::ScaleParam ImageUtils::GetScaleParam(const cv::Size &src_size, int target_max_side_len) {
+    int max_side = std::max(src_size.width, src_size.height);
     float ratio = static_cast<float>(target_max_side_len) / max_side;
-    return GetScaleParam(src, ratio);
+    return GetScaleParam(src_size, ratio);
 }
 
 } // namespace utils
@@ -1,8 +1,14 @@
 #include "utils/ocr_utils.h"
 #include "utils/clipper.hpp"
+#include "utils/simd_utils.h"
 
 #include <onnxruntime_cxx_api.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+
 namespace utils {
 
 void OcrUtils::GetInputName(std::shared_ptr<Ort::Session> session, std::string &input_name) {
@@ -32,16 +38,87 @@ void OcrUtils::GetOutputName(std::shared_ptr<Ort::Session> session, std::string
 std::vector<float> OcrUtils::SubstractMeanNormalize(const cv::Mat &image, const std::vector<float> &mean, const std::vector<float> &norm) {
     auto size = image.cols * image.rows * image.channels();
     std::vector<float> result(size);
+    SubstractMeanNormalize(image, mean, norm, result.data());
+    return result;
+}
+
+void OcrUtils::SubstractMeanNormalize(const cv::Mat &image, const std::vector<float> &mean, const std::vector<float> &norm, float *dest) {
     size_t num_channels = image.channels();
     size_t image_size = image.cols * image.rows;
 
+    // 三通道图像按行走向量化实现
+    if (image.type() == CV_8UC3) {
+        const int src_ch[3] = {0, 1, 2};
+        float scale[3], bias[3];
+        for (int ch = 0; ch < 3; ++ch) {
+            scale[ch] = norm[ch];
+            bias[ch] = -mean[ch] * norm[ch];
+        }
+        for (int y = 0; y < image.rows; ++y) {
+            size_t offset = static_cast<size_t>(y) * image.cols;
+            SimdUtils::NormalizeRow(image.ptr<uchar>(y), image.cols, src_ch, scale, bias, dest + offset, dest + image_size + offset, dest + 2 * image_size + offset);
+        }
+        return;
+    }
+
     for (size_t pos = 0; pos < image_size; pos++) {
         for (size_t ch = 0; ch < num_channels; ++ch) {
             float data = static_cast<float>((image.data[num_channels * pos + ch] - mean[ch]) * norm[ch]);
-            result[ch * image_size + pos] = data;
+            dest[ch * image_size + pos] = data;
         }
     }
-    return result;
+}
+
+void OcrUtils::ResizeNormalize(const cv::Mat &src, int resize_width, int resize_height, int dest_stride, const std::vector<float> &mean, const std::vector<float> &norm, bool swap_rb, const cv::Scalar &pad_value, float *dest) {
+    ResizeNormalize(src, resize_width, resize_height, dest_stride, resize_height, mean, norm, swap_rb, pad_value, dest);
+}
+
+void OcrUtils::ResizeNormalize(const cv::Mat &src, int resize_width, int resize_height, int dest_stride, int dest_rows, const std::vector<float> &mean, const std::vector<float> &norm, bool swap_rb, const cv::Scalar &pad_value, float *dest) {
+    // 与 cv::resize 一致, 空图像或非正的目标尺寸抛出 cv::Exception
+    CV_Assert(!src.empty() && src.type() == CV_8UC3);
+    CV_Assert(resize_width > 0 && resize_height > 0);
+    const int channels = 3;
+    int width = std::min(resize_width, dest_stride);
+    resize_height = std::min(resize_height, dest_rows);
+    size_t plane_size = static_cast<size_t>(dest_rows) * dest_stride;
+
+    int src_ch[channels] = {0, 1, 2};
+    if (swap_rb) {
+        src_ch[0] = 2;
+        src_ch[2] = 0;
+    }
+    // (v - mean) * norm = v * scale + bias
+    float scale[channels], bias[channels];
+    float *planes[channels];
+    for (int ch = 0; ch < channels; ++ch) {
+        scale[ch] = norm[ch];
+        bias[ch] = -mean[ch] * norm[ch];
+        planes[ch] = dest + ch * plane_size;
+    }
+
+    // 填充右侧空白列与底部空白行
+    if (width < dest_stride || resize_height < dest_rows) {
+        for (int ch = 0; ch < channels; ++ch) {
+            float value = static_cast<float>((pad_value[src_ch[ch]] - mean[ch]) * norm[ch]);
+            for (int y = 0; y < resize_height; ++y) {
+                std::fill(planes[ch] + y * dest_stride + width, planes[ch] + (y + 1) * dest_stride, value);
+            }
+            std::fill(planes[ch] + static_cast<size_t>(resize_height) * dest_stride, planes[ch] + plane_size, value);
+        }
+    }
+
+    // 缩放交给 OpenCV 的向量化实现 (与原先的 cv::resize 结果一致), 之后逐行交换通道、归一化并拆分到各通道平面.
+    // 尺寸一致时直接读取 src; 只缩放实际写入的 width 列
+    const cv::Mat *resized = &src;
+    thread_local cv::Mat resize_image;
+    if (resize_width != src.cols || resize_height != src.rows) {
+        cv::resize(src, resize_image, cv::Size(resize_width, resize_height));
+        resized = &resize_image;
+    }
+    for (int y = 0; y < resize_height; ++y) {
+        size_t offset = static_cast<size_t>(y) * dest_stride;
+        SimdUtils::NormalizeRow(resized->ptr<uchar>(y), width, src_ch, scale, bias, planes[0] + offset, planes[1] + offset, planes[2] + offset);
+    }
 }
 
 std::vector<cv::Point> OcrUtils::GetMinBoxes(const std::vector<cv::Point> &points, float &min_side_len, float &perimeter) {
@@ -84,35 +161,297 @@ std::vector<cv::Point> OcrUtils::GetMinBoxes(const std::vector<cv::Point> &point
 }
 
 float OcrUtils::BoxScoreFast(const cv::Mat &feat, const std::vector<cv::Point> &box) {
-    std::vector<cv::Point> box_temp(box);
+    CV_Assert(feat.type() == CV_32FC1);
     int width = feat.cols;
     int height = feat.rows;
+    int size = box.size();
+    if (size == 0) return 0.0f;
+
+    int min_y = height - 1, max_y = 0;
+    for (const auto &point : box) {
+        min_y = std::min(min_y, point.y);
+        max_y = std::max(max_y, point.y);
+    }
+    min_y = std::max(0, min_y);
+    max_y = std::min(height - 1, max_y);
+
+    // 逐行扫描: 内部按奇偶规则取交点区间, 再并上边本身经过的像素, 合并后直接在 feat 上累加
+    thread_local std::vector<double> crossings;
+    thread_local std::vector<std::pair<int, int>> spans;
+    double sum = 0.0;
+    int64_t count = 0;
+    for (int y = min_y; y <= max_y; ++y) {
+        crossings.clear();
+        spans.clear();
+        for (int i = 0; i < size; ++i) {
+            const cv::Point &p0 = box[i];
+            const cv::Point &p1 = box[(i + 1) % size];
+            int y0 = std::min(p0.y, p1.y);
+            int y1 = std::max(p0.y, p1.y);
+            if (y < y0 || y > y1) continue;
+            if (y0 == y1) {
+                spans.emplace_back(std::min(p0.x, p1.x), std::max(p0.x, p1.x));
+                continue;
+            }
+            double slope = static_cast<double>(p1.x - p0.x) / (p1.y - p0.y);
+            // 交点按半开区间 [y0, y1) 统计, 避免顶点被重复计数
+            if (y < y1) {
+                crossings.push_back(p0.x + (y - p0.y) * slope);
+            }
+            // 边在本行 [y - 0.5, y + 0.5] 范围内经过的像素, 即像素区间 [x - 0.5, x + 0.5] 与之相交的 x
+            double xa = p0.x + (std::max<double>(y0, y - 0.5) - p0.y) * slope;
+            double xb = p0.x + (std::min<double>(y1, y + 0.5) - p0.y) * slope;
+            int x0 = static_cast<int>(std::floor(std::min(xa, xb) - 0.5)) + 1;
+            int x1 = static_cast<int>(std::ceil(std::max(xa, xb) + 0.5)) - 1;
+            spans.emplace_back(x0, x1);
+        }
+        std::sort(crossings.begin(), crossings.end());
+        for (size_t k = 0; k + 1 < crossings.size(); k += 2) {
+            int x0 = static_cast<int>(std::ceil(crossings[k]));
+            int x1 = static_cast<int>(std::floor(crossings[k + 1]));
+            if (x0 <= x1) spans.emplace_back(x0, x1);
+        }
+        if (spans.empty()) continue;
+
+        std::sort(spans.begin(), spans.end());
+        const float *row = feat.ptr<float>(y);
+        int start = spans[0].first, end = spans[0].second;
+        for (size_t k = 1; k <= spans.size(); ++k) {
+            if (k < spans.size() && spans[k].first <= end + 1) {
+                end = std::max(end, spans[k].second);
+                continue;
+            }
+            int x0 = std::max(0, start), x1 = std::min(width - 1, end);
+            for (int x = x0; x <= x1; ++x) {
+                sum += row[x];
+            }
+            count += std::max(0, x1 - x0 + 1);
+            if (k < spans.size()) {
+                start = spans[k].first;
+                end = spans[k].second;
+            }
+        }
+    }
+    return count > 0 ? static_cast<float>(sum / count) : 0.0f;
+}
+
+float OcrUtils::BoxScoreIntegral(const cv::Mat &integral_feat, const std::vector<cv::Point> &box) {
+    CV_Assert(integral_feat.type() == CV_64FC1);
+    int width = integral_feat.cols - 1;
+    int height = integral_feat.rows - 1;
 
     int min_x = width - 1, min_y = height - 1;
     int max_x = 0, max_y = 0;
-    // 计算最小外接矩形的两个顶点
     for (const auto &point : box) {
         min_x = std::min(min_x, point.x);
         min_y = std::min(min_y, point.y);
         max_x = std::max(max_x, point.x);
         max_y = std::max(max_y, point.y);
     }
+    min_x = std::max(0, min_x);
+    min_y = std::max(0, min_y);
+    max_x = std::min(width - 1, max_x);
+    max_y = std::min(height - 1, max_y);
+    if (min_x > max_x || min_y > max_y) return 0.0f;
+
+    // 外接矩形内的均值, 四次查表
+    double sum = integral_feat.at<double>(max_y + 1, max_x + 1) - integral_feat.at<double>(min_y, max_x + 1) -
+                 integral_feat.at<double>(max_y + 1, min_x) + integral_feat.at<double>(min_y, min_x);
+    return static_cast<float>(sum / ((max_x - min_x + 1) * (max_y - min_y + 1)));
+}
+
+namespace {
+
+// 同一行内连续的前景像素
+struct Run {
+    int y;
+    int start;
+    int end;
+    int label;
+};
+
+int FindRoot(std::vector<int> &parents, int label) {
+    while (parents[label] != label) {
+        parents[label] = parents[parents[label]];
+        label = parents[label];
+    }
+    return label;
+}
+
+} // namespace
+
+void OcrUtils::FindComponents(const cv::Mat &binary_feat, const cv::Mat &feat, std::vector<base::TextComponent> &components, const std::vector<cv::Range> *row_ranges) {
+    CV_Assert(binary_feat.type() == CV_8UC1 && feat.type() == CV_32FC1 && binary_feat.size() == feat.size());
+    components.clear();
+
+    // 第一遍: 逐行提取行程, 与上一行 8 邻接的行程合并到同一集合
+    thread_local std::vector<Run> runs;
+    thread_local std::vector<int> parents;
+    runs.clear();
+    parents.clear();
+    size_t prev_begin = 0, prev_end = 0;
+    for (int y = 0; y < binary_feat.rows; ++y) {
+        const uchar *row = binary_feat.ptr<uchar>(y);
+        size_t cur_begin = runs.size();
+        size_t prev = prev_begin;
+        int x_begin = row_ranges ? (*row_ranges)[y].start : 0;
+        int x_end = row_ranges ? (*row_ranges)[y].end : binary_feat.cols;
+        for (int x = x_begin; x < x_end; ++x) {
+            if (!row[x]) continue;
+            int start = x;
+            while (x + 1 < x_end && row[x + 1]) ++x;
+            int label = parents.size();
+            parents.push_back(label);
+            runs.push_back({y, start, x, label});
+
+            // 上一行的行程按起点有序, 跳过完全在左侧的行程
+            while (prev < prev_end && runs[prev].end < start - 1) ++prev;
+            for (size_t k = prev; k < prev_end && runs[k].start <= x + 1; ++k) {
+                int root_a = FindRoot(parents, runs[k].label);
+                int root_b = FindRoot(parents, label);
+                if (root_a != root_b) {
+                    // 保留较小的标号, 使连通域顺序只取决于首个像素
+                    parents[std::max(root_a, root_b)] = std::min(root_a, root_b);
+                }
+            }
+        }
+        prev_begin = cur_begin;
+        prev_end = runs.size();
+    }
+
+    // 第二遍: 按根标号汇总每个连通域
+    thread_local std::vector<int> indexes;
+    indexes.assign(parents.size(), -1);
+    for (const Run &run : runs) {
+        int root = FindRoot(parents, run.label);
+        if (indexes[root] < 0) {
+            indexes[root] = components.size();
+            components.push_back({cv::Rect(run.start, run.y, 0, 0), 0, 0.0, 0, {}});
+        }
+        base::TextComponent &component = components[indexes[root]];
+
+        int left = std::min(component.rect.x, run.start);
+        int right = std::max(component.rect.x + component.rect.width, run.end + 1);
+        component.rect.x = left;
+        component.rect.width = right - left;
+        component.rect.height = run.y - component.rect.y + 1;
+        component.area += run.end - run.start + 1;
+
+        // 行程按 x 递增, 同一行只需更新最右端
+        std::vector<cv::Point> &points = component.points;
+        if (!points.empty() && points.back().y == run.y) {
+            points.back().x = run.end;
+        } else {
+            points.emplace_back(run.start, run.y);
+            points.emplace_back(run.end, run.y);
+        }
+    }
 
-    for (auto &point : box_temp) {
-        point.x -= min_x;
-        point.y -= min_y;
+    // 得分按每行最左到最右像素之间求和, 与轮廓多边形的填充范围一致, 不只统计阈值以上的像素
+    for (base::TextComponent &component : components) {
+        const std::vector<cv::Point> &points = component.points;
+        for (size_t i = 0; i + 1 < points.size(); i += 2) {
+            const float *feat_row = feat.ptr<float>(points[i].y);
+            double sum = 0.0;
+            for (int x = points[i].x; x <= points[i + 1].x; ++x) {
+                sum += feat_row[x];
+            }
+            component.score_sum += sum;
+            component.span_area += points[i + 1].x - points[i].x + 1;
+        }
     }
+}
 
-    // 创建 mask
-    cv::Mat mask(max_y - min_y + 1, max_x - min_x + 1, CV_8UC1, cv::Scalar(0, 0, 0));
-    cv::fillPoly(mask, {box_temp}, cv::Scalar(1, 1, 1), 1);
+void OcrUtils::FindBandContours(const cv::Mat &binary_feat, const std::vector<cv::Range> &row_ranges, std::vector<std::vector<cv::Point>> &contours) {
+    contours.clear();
+    // 连续的非空行组成一个行带, 8 邻接的轮廓不会跨越空行
+    std::vector<cv::Rect> bands;
+    int rows = std::min(binary_feat.rows, static_cast<int>(row_ranges.size()));
+    for (int y = 0; y < rows;) {
+        if (row_ranges[y].empty()) {
+            ++y;
+            continue;
+        }
+        int top = y, left = row_ranges[y].start, right = row_ranges[y].end;
+        for (; y < rows && !row_ranges[y].empty(); ++y) {
+            left = std::min(left, row_ranges[y].start);
+            right = std::max(right, row_ranges[y].end);
+        }
+        bands.emplace_back(left, top, right - left, y - top);
+    }
 
-    // 计算指定区域的平均值，即平均像素强度
-    cv::Mat region = feat(cv::Rect(cv::Point(min_x, min_y), cv::Point(max_x + 1, max_y + 1))).clone();
-    return cv::mean(region, mask).val[0];
+    // findContours 先输出后发现的轮廓, 整图中下方行带的轮廓排在前面; 行带自下而上拼接, 与整图的输出顺序一致
+    std::vector<std::vector<cv::Point>> band_contours;
+    for (auto band = bands.rbegin(); band != bands.rend(); ++band) {
+        cv::findContours(binary_feat(*band), band_contours, cv::RETR_LIST, cv::CHAIN_APPROX_SIMPLE, band->tl());
+        for (auto &contour : band_contours) {
+            contours.emplace_back(std::move(contour));
+        }
+    }
 }
 
 std::vector<cv::Point> OcrUtils::UnClip(const std::vector<cv::Point> &box, float perimeter, float unclip_ratio) {
+    // 检测得到的 box 均为凸四边形, 直接解析求解, 其余情况交给 Clipper
+    std::vector<cv::Point> out_box;
+    if (UnClipConvexQuad(box, perimeter, unclip_ratio, out_box)) {
+        return out_box;
+    }
+    return UnClipClipper(box, perimeter, unclip_ratio);
+}
+
+bool OcrUtils::UnClipConvexQuad(const std::vector<cv::Point> &box, float perimeter, float unclip_ratio, std::vector<cv::Point> &out_box) {
+    if (box.size() != 4 || perimeter <= 0.0f) return false;
+
+    // 与 ClipperLib::Area 相同的有向面积, 保证扩张距离的符号与 Clipper 路径一致
+    double area = 0.0;
+    for (int i = 0, j = 3; i < 4; j = i++) {
+        area += (static_cast<double>(box[j].x) + box[i].x) * (static_cast<double>(box[j].y) - box[i].y);
+    }
+    area = -area * 0.5;
+    double distance = unclip_ratio * area / static_cast<double>(perimeter);
+    // 收缩时可能整体消失, 交给 Clipper 处理
+    if (distance <= 0.0) return false;
+
+    // 统一为面积为正的走向, 此时 (dy, -dx) 为各边的外法向
+    cv::Point2d points[4];
+    for (int i = 0; i < 4; ++i) {
+        points[i] = area >= 0 ? cv::Point2d(box[i].x, box[i].y) : cv::Point2d(box[3 - i].x, box[3 - i].y);
+    }
+    cv::Point2d normals[4];
+    for (int i = 0; i < 4; ++i) {
+        cv::Point2d edge = points[(i + 1) % 4] - points[i];
+        double length = std::sqrt(edge.x * edge.x + edge.y * edge.y);
+        if (length < 1e-6) return false;
+        normals[i] = cv::Point2d(edge.y / length, -edge.x / length);
+    }
+
+    // 相邻两边同向转折才是凸四边形
+    double first_cross = 0.0;
+    for (int i = 0; i < 4; ++i) {
+        const cv::Point2d &n0 = normals[i];
+        const cv::Point2d &n1 = normals[(i + 1) % 4];
+        double cross = n0.x * n1.y - n0.y * n1.x;
+        if (std::fabs(cross) < 1e-9) return false;
+        if (i == 0) first_cross = cross;
+        else if ((cross > 0) != (first_cross > 0)) return false;
+    }
+
+    // 每条边沿外法向平移 distance, 相邻两边的交点即新的顶点: v = p + d * (n0 + n1) / (1 + n0 · n1)
+    out_box.resize(4);
+    for (int i = 0; i < 4; ++i) {
+        const cv::Point2d &n0 = normals[(i + 3) % 4];
+        const cv::Point2d &n1 = normals[i];
+        double denom = 1.0 + n0.x * n1.x + n0.y * n1.y;
+        // 夹角过尖时斜接点过远, 与圆角结果偏差大
+        if (denom < 0.5) return false;
+        double scale = distance / denom;
+        out_box[i] = cv::Point(static_cast<int>(std::round(points[i].x + scale * (n0.x + n1.x))),
+                               static_cast<int>(std::round(points[i].y + scale * (n0.y + n1.y))));
+    }
+    return true;
+}
+
+std::vector<cv::Point> OcrUtils::UnClipClipper(const std::vector<cv::Point> &box, float perimeter, float unclip_ratio) {
     ClipperLib::Path poly;
     for (const auto &point : box) {
         poly.push_back(ClipperLib::IntPoint(point.x, point.y));
@@ -136,6 +475,150 @@ std::vector<cv::Point> OcrUtils::UnClip(const std::vector<cv::Point> &box, float
     return out_box;
 }
 
+std::vector<cv::Rect> OcrUtils::GetTileRects(const cv::Size &size, int tile_size, int overlap) {
+    tile_size = std::max(1, tile_size);
+    overlap = std::min(std::max(0, overlap), tile_size / 2);
+    int step = tile_size - overlap;
+
+    auto get_starts = [&](int length) {
+        std::vector<int> starts{0};
+        while (starts.back() + tile_size < length) {
+            starts.push_back(std::min(starts.back() + step, length - tile_size));
+        }
+        return starts;
+    };
+
+    std::vector<cv::Rect> rects;
+    for (int y : get_starts(size.height)) {
+        for (int x : get_starts(size.width)) {
+            rects.emplace_back(x, y, std::min(tile_size, size.width - x), std::min(tile_size, size.height - y));
+        }
+    }
+    return rects;
+}
+
+std::vector<base::TextBox> OcrUtils::MergeTileBoxes(const std::vector<std::vector<base::TextBox>> &tile_boxes, const std::vector<cv::Rect> &tile_rects, const cv::Size &size) {
+    // 贴近分块内部边界的距离, 被截断的框经 UnClip 扩张后会被裁到分块边缘
+    const int edge_margin = 4;
+    const float merge_ratio = 0.5f;
+
+    struct Item {
+        int tile;
+        cv::Rect rect;
+        bool cut_x; // 在左右内部边界被截断
+        bool cut_y; // 在上下内部边界被截断
+    };
+    std::vector<const base::TextBox *> boxes;
+    std::vector<Item> items;
+    for (size_t t = 0; t < tile_boxes.size(); ++t) {
+        const cv::Rect &tile = tile_rects[t];
+        bool inner_left = tile.x > 0, inner_right = tile.x + tile.width < size.width;
+        bool inner_top = tile.y > 0, inner_bottom = tile.y + tile.height < size.height;
+        for (const auto &box : tile_boxes[t]) {
+            cv::Rect rect = cv::boundingRect(box.points);
+            Item item{static_cast<int>(t), rect, false, false};
+            item.cut_x = (inner_left && rect.x - tile.x <= edge_margin) ||
+                         (inner_right && tile.x + tile.width - (rect.x + rect.width) <= edge_margin);
+            item.cut_y = (inner_top && rect.y - tile.y <= edge_margin) ||
+                         (inner_bottom && tile.y + tile.height - (rect.y + rect.height) <= edge_margin);
+            boxes.push_back(&box);
+            items.push_back(item);
+        }
+    }
+
+    // 只有伸入其他分块 (即位于重叠带或接缝附近) 的框才可能与其他分块的框重合, 其余框直接各成一组
+    int num_boxes = items.size();
+    std::vector<int> seam_items;
+    for (int i = 0; i < num_boxes; ++i) {
+        for (size_t t = 0; t < tile_rects.size(); ++t) {
+            if (static_cast<int>(t) == items[i].tile) continue;
+            cv::Rect tile = tile_rects[t];
+            tile.x -= edge_margin;
+            tile.y -= edge_margin;
+            tile.width += 2 * edge_margin;
+            tile.height += 2 * edge_margin;
+            if ((items[i].rect & tile).area() > 0) {
+                seam_items.push_back(i);
+                break;
+            }
+        }
+    }
+
+    // 接缝附近的框按左边界排序后扫描, 只比较横向相交的框, 满足条件的归入同一集合
+    std::sort(seam_items.begin(), seam_items.end(), [&](int a, int b) { return items[a].rect.x < items[b].rect.x; });
+    std::vector<int> parents(num_boxes);
+    std::iota(parents.begin(), parents.end(), 0);
+    for (size_t m = 0; m < seam_items.size(); ++m) {
+        const Item &a = items[seam_items[m]];
+        for (size_t n = m + 1; n < seam_items.size(); ++n) {
+            const Item &b = items[seam_items[n]];
+            if (b.rect.x >= a.rect.x + a.rect.width) break;
+            if (a.tile == b.tile) continue;
+            cv::Rect inter = a.rect & b.rect;
+            if (inter.area() <= 0) continue;
+
+            float overlap_x = static_cast<float>(inter.width) / std::max(1, std::min(a.rect.width, b.rect.width));
+            float overlap_y = static_cast<float>(inter.height) / std::max(1, std::min(a.rect.height, b.rect.height));
+            float overlap_area = static_cast<float>(inter.area()) / std::max(1, std::min(a.rect.area(), b.rect.area()));
+            // 重复检测; 或同一行在竖直边界被截断, 纵向基本重合; 或在水平边界被截断, 横向基本重合
+            bool is_same = overlap_area > merge_ratio ||
+                           ((a.cut_x || b.cut_x) && overlap_y > merge_ratio) ||
+                           ((a.cut_y || b.cut_y) && overlap_x > merge_ratio);
+            if (is_same) {
+                int root_a = FindRoot(parents, seam_items[m]), root_b = FindRoot(parents, seam_items[n]);
+                if (root_a != root_b) parents[std::max(root_a, root_b)] = std::min(root_a, root_b);
+            }
+        }
+    }
+
+    // 每个集合取所有顶点的最小外接矩形, 得分取最大值
+    std::vector<int> indexes(num_boxes, -1);
+    std::vector<std::vector<cv::Point>> groups;
+    std::vector<float> scores;
+    for (int i = 0; i < num_boxes; ++i) {
+        int root = FindRoot(parents, i);
+        if (indexes[root] < 0) {
+            indexes[root] = groups.size();
+            groups.emplace_back();
+            scores.push_back(0.0f);
+        }
+        int index = indexes[root];
+        groups[index].insert(groups[index].end(), boxes[i]->points.begin(), boxes[i]->points.end());
+        scores[index] = std::max(scores[index], boxes[i]->score);
+    }
+
+    std::vector<base::TextBox> merged_boxes;
+    for (size_t i = 0; i < groups.size(); ++i) {
+        if (groups[i].size() == 4) {
+            merged_boxes.push_back(base::TextBox{groups[i], scores[i]});
+            continue;
+        }
+        float min_side_len, perimeter;
+        std::vector<cv::Point> points = GetMinBoxes(groups[i], min_side_len, perimeter);
+        for (auto &point : points) {
+            point.x = std::min(std::max(0, point.x), size.width);
+            point.y = std::min(std::max(0, point.y), size.height);
+        }
+        merged_boxes.push_back(base::TextBox{points, scores[i]});
+    }
+
+    // 集合按分块顺序生成; 按外接矩形的 (上边界, 左边界) 排序, 与不分块时自上而下的输出顺序一致
+    std::vector<cv::Rect> rects;
+    for (const auto &box : merged_boxes) {
+        rects.push_back(cv::boundingRect(box.points));
+    }
+    std::vector<int> order(merged_boxes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return rects[a].y != rects[b].y ? rects[a].y < rects[b].y : rects[a].x < rects[b].x;
+    });
+    std::vector<base::TextBox> sorted_boxes;
+    for (int index : order) {
+        sorted_boxes.emplace_back(std::move(merged_boxes[index]));
+    }
+    return sorted_boxes;
+}
+
 std::vector<int> OcrUtils::GetAngleIndexes(const std::vector<base::Angle> &angles) {
     std::vector<int> result(angles.size());
     for (size_t i = 0; i < angles.size(); i++) {
@@ -144,6 +627,12 @@ std::vector<int> OcrUtils::GetAngleIndexes(const std::vector<base::Angle> &angle
     return result;
 }
 
+int OcrUtils::GetMostAngleIndex(const std::vector<base::Angle> &angles) {
+    std::vector<int> indexes = GetAngleIndexes(angles);
+    int sum = std::accumulate(indexes.begin(), indexes.end(), 0);
+    return 2 * sum < static_cast<int>(indexes.size()) ? 0 : 1;
+}
+
 void OcrUtils::DrawTextBox(cv::Mat &src, const cv::RotatedRect &rect, int thickness) {
     cv::Point2f vertices[4];
     rect.points(vertices);
@@ -0,0 +1,190 @@
+#include "utils/session_pool.h"
+#include "utils/file_utils.h"
+#include "utils/simd_utils.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+
+namespace utils {
+
+namespace {
+
+uint64_t Fnv1a(const void *data, size_t length) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// 优化后的图可能包含与指令集相关的算子选择, 缓存键需区分 CPU
+std::string GetCpuTag() {
+    std::string tag = SimdUtils::GetIsaName();
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx512vnni")) {
+        tag += "vnni";
+    }
+#endif
+    return tag;
+}
+
+// 缓存键: <模型哈希>-ort<版本>-<EP>-<指令集>-o<优化级别>, 不含扩展名
+std::string GetCacheKey(const void *model_data, size_t model_data_length, const std::string &execution_provider, GraphOptimizationLevel optimization_level) {
+    char hash[17];
+    snprintf(hash, sizeof(hash), "%016" PRIx64, Fnv1a(model_data, model_data_length));
+    std::string version = OrtGetApiBase()->GetVersionString();
+    return std::string(hash) + "-ort" + version + "-" + execution_provider + "-" + GetCpuTag() + "-o" + std::to_string(static_cast<int>(optimization_level));
+}
+
+} // namespace
+
+SessionPool::SessionPool() : size_(0), num_threads_(0), optimization_level_(ORT_ENABLE_ALL), execution_provider_("cpu"), next_(0) {}
+
+SessionPool::~SessionPool() {
+    // Session 需先于预打包权重容器释放
+    sessions_.clear();
+}
+
+void SessionPool::SetSize(int size) {
+    size_ = std::max(0, size);
+}
+
+void SessionPool::SetNumThreads(int num_threads) {
+    num_threads_ = std::max(0, num_threads);
+}
+
+void SessionPool::SetPrepackedWeights(const std::shared_ptr<Ort::PrepackedWeightsContainer> &prepacked_weights) {
+    prepacked_weights_ = prepacked_weights;
+}
+
+void SessionPool::SetCacheDir(const std::string &cache_dir, GraphOptimizationLevel optimization_level, const std::string &execution_provider) {
+    cache_dir_ = cache_dir;
+    optimization_level_ = optimization_level;
+    execution_provider_ = execution_provider;
+}
+
+void SessionPool::Init(Ort::Env &env, const std::string &model_path, const Ort::SessionOptions &options) {
+    SessionFactory create_session = [&](const Ort::SessionOptions &session_options, OrtPrepackedWeightsContainer *prepacked_weights) {
+        if (prepacked_weights) {
+            return std::make_shared<Ort::Session>(env, model_path.c_str(), session_options, prepacked_weights);
+        }
+        return std::make_shared<Ort::Session>(env, model_path.c_str(), session_options);
+    };
+    if (!cache_dir_.empty()) {
+        // 缓存以模型内容为键, 需读取整个文件计算哈希
+        MappedFile model_file;
+        if (model_file.Open(model_path) && LoadCached(env, model_file.data(), model_file.size(), create_session, options, false)) {
+            return;
+        }
+    }
+    Load(create_session, options);
+}
+
+void SessionPool::Init(Ort::Env &env, const void *model_data, size_t model_data_length, const Ort::SessionOptions &options) {
+    // 在副本上追加配置, 不影响调用方的 options. 只对 ORT 格式的模型有效: Session 直接引用 model_data,
+    // 常量权重也不再复制到堆上; ONNX 格式需先解析 protobuf, 权重总会复制一份, 两项配置均被忽略
+    Ort::SessionOptions bytes_options = options.Clone();
+    bytes_options.AddConfigEntry("session.use_ort_model_bytes_directly", "1");
+    bytes_options.AddConfigEntry("session.use_ort_model_bytes_for_initializers", "1");
+    SessionFactory create_session = [&](const Ort::SessionOptions &session_options, OrtPrepackedWeightsContainer *prepacked_weights) {
+        if (prepacked_weights) {
+            return std::make_shared<Ort::Session>(env, model_data, model_data_length, session_options, prepacked_weights);
+        }
+        return std::make_shared<Ort::Session>(env, model_data, model_data_length, session_options);
+    };
+    if (!cache_dir_.empty() && LoadCached(env, model_data, model_data_length, create_session, bytes_options, true)) {
+        return;
+    }
+    Load(create_session, bytes_options);
+}
+
+bool SessionPool::LoadCached(Ort::Env &env, const void *model_data, size_t model_data_length, const SessionFactory &create_session, const Ort::SessionOptions &options, bool map_cache) {
+    if (!FileUtils::IsDirectory(cache_dir_) && !FileUtils::CreateDir(cache_dir_)) {
+        std::cerr << "SessionPool cache dir error: " << cache_dir_ << std::endl;
+        return false;
+    }
+    std::string cache_key = GetCacheKey(model_data, model_data_length, execution_provider_, optimization_level_);
+    std::string cache_path = FileUtils::JoinPath(cache_dir_, cache_key + ".ort");
+
+    // 命中: 缓存中的图已经优化过, 加载时不再优化. 原模型从内存加载时, 缓存文件同样以内存映射加载,
+    // 缓存为 ORT 格式, 常量权重直接引用映射的页, 多个进程加载同一缓存时共用这部分物理内存
+    if (FileUtils::IsFileExist(cache_path)) {
+        Ort::SessionOptions cached_options = options.Clone();
+        cached_options.SetGraphOptimizationLevel(ORT_DISABLE_ALL);
+        // 重新 Init 时旧的 Session 可能仍引用上一次的映射, 先释放
+        sessions_.clear();
+        try {
+            if (map_cache && cache_file_.Open(cache_path)) {
+                Load([&](const Ort::SessionOptions &session_options, OrtPrepackedWeightsContainer *prepacked_weights) {
+                    if (prepacked_weights) {
+                        return std::make_shared<Ort::Session>(env, cache_file_.data(), cache_file_.size(), session_options, prepacked_weights);
+                    }
+                    return std::make_shared<Ort::Session>(env, cache_file_.data(), cache_file_.size(), session_options);
+                }, cached_options);
+            } else {
+                Load([&](const Ort::SessionOptions &session_options, OrtPrepackedWeightsContainer *prepacked_weights) {
+                    if (prepacked_weights) {
+                        return std::make_shared<Ort::Session>(env, cache_path.c_str(), session_options, prepacked_weights);
+                    }
+                    return std::make_shared<Ort::Session>(env, cache_path.c_str(), session_options);
+                }, cached_options);
+            }
+            return true;
+        } catch (const Ort::Exception &e) {
+            // 缓存文件损坏时删除, 按原模型重新生成
+            std::cerr << "SessionPool cache load error: " << cache_path << ", " << e.what() << std::endl;
+            sessions_.clear();
+            cache_file_.Close();
+            std::remove(cache_path.c_str());
+        }
+    }
+
+    // 未命中: 先写入本进程独占的临时文件, 完成后改名, 其他进程不会读到写了一半的缓存.
+    // 临时文件同样以 .ort 结尾, 否则 ORT 会按 ONNX 格式保存
+    std::string temp_path = FileUtils::JoinPath(cache_dir_, cache_key + ".tmp" + std::to_string(getpid()) + ".ort");
+    Load(create_session, options, temp_path);
+    if (std::rename(temp_path.c_str(), cache_path.c_str()) != 0) {
+        std::cerr << "SessionPool cache write error: " << cache_path << std::endl;
+        std::remove(temp_path.c_str());
+    }
+    return true;
+}
+
+void SessionPool::Load(const SessionFactory &create_session, const Ort::SessionOptions &pool_options, const std::string &optimized_model_path) {
+    sessions_.clear();
+    next_ = 0;
+
+    // 多个 Session 可能同时推理, 各自的线程池只取总线程数的一份
+    Ort::SessionOptions options = pool_options.Clone();
+    if (size_ > 1) {
+        int num_threads = num_threads_ > 0 ? num_threads_ : static_cast<int>(std::thread::hardware_concurrency());
+        options.SetIntraOpNumThreads(std::max(1, num_threads / size_));
+    }
+
+    // 多个 Session 之间共享预打包后的权重, 避免每个 Session 各存一份
+    if (!prepacked_weights_ && size_ > 1) {
+        prepacked_weights_ = std::make_shared<Ort::PrepackedWeightsContainer>();
+    }
+    OrtPrepackedWeightsContainer *prepacked_weights = nullptr;
+    if (prepacked_weights_) {
+        prepacked_weights = *prepacked_weights_;
+    }
+    for (int i = 0; i < std::max(1, size_); ++i) {
+        if (i == 0 && !optimized_model_path.empty()) {
+            Ort::SessionOptions save_options = options.Clone();
+            save_options.SetOptimizedModelFilePath(optimized_model_path.c_str());
+            save_options.AddConfigEntry("session.save_model_format", "ORT");
+            sessions_.emplace_back(create_session(save_options, prepacked_weights));
+        } else {
+            sessions_.emplace_back(create_session(options, prepacked_weights));
+        }
+    }
+}
+
+} // namespace utils
@@ -0,0 +1,431 @@
+#include "utils/simd_utils.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define OCR_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace utils {
+
+namespace {
+
+typedef void (*NormalizeRowFunc)(const uint8_t *, int, const int *, const float *, const float *, float *const *);
+typedef int (*ArgMaxFunc)(const float *, int, float &);
+typedef float (*SumExpFunc)(const float *, int, float);
+typedef int (*ThresholdRowFunc)(const float *, int, float, uint8_t *, int &, int &);
+
+void NormalizeRowScalar(const uint8_t *src, int width, const int *src_ch, const float *scale, const float *bias, float *const *dest) {
+    for (int x = 0; x < width; ++x) {
+        const uint8_t *pixel = src + x * 3;
+        dest[0][x] = pixel[src_ch[0]] * scale[0] + bias[0];
+        dest[1][x] = pixel[src_ch[1]] * scale[1] + bias[1];
+        dest[2][x] = pixel[src_ch[2]] * scale[2] + bias[2];
+    }
+}
+
+int ArgMaxScalar(const float *data, int size, float &max_value) {
+    int max_index = 0;
+    max_value = size > 0 ? data[0] : 0.0f;
+    for (int i = 1; i < size; ++i) {
+        if (data[i] > max_value) {
+            max_value = data[i];
+            max_index = i;
+        }
+    }
+    return max_index;
+}
+
+float SumExpScalar(const float *data, int size, float offset) {
+    float sum = 0.0f;
+    for (int i = 0; i < size; ++i) {
+        sum += std::exp(data[i] - offset);
+    }
+    return sum;
+}
+
+// 处理 [begin, width) 的剩余像素, 累加到已有的统计上
+int ThresholdTail(const float *src, int begin, int width, float threshold, uint8_t *dest, int &first, int &last) {
+    int count = 0;
+    for (int x = begin; x < width; ++x) {
+        bool is_set = src[x] > threshold;
+        dest[x] = is_set ? 255 : 0;
+        if (is_set) {
+            first = std::min(first, x);
+            last = x;
+            ++count;
+        }
+    }
+    return count;
+}
+
+int ThresholdRowScalar(const float *src, int width, float threshold, uint8_t *dest, int &first, int &last) {
+    first = width;
+    last = -1;
+    return ThresholdTail(src, 0, width, threshold, dest, first, last);
+}
+
+#ifdef OCR_SIMD_X86
+
+// 累加一组像素的掩码统计, mask 的第 k 位对应 base + k
+inline int AccumulateMask(uint32_t mask, int base, int &first, int &last) {
+    if (mask == 0) return 0;
+    first = std::min(first, base + __builtin_ctz(mask));
+    last = base + 31 - __builtin_clz(mask);
+    return __builtin_popcount(mask);
+}
+
+// 将 16 个交错像素 (48 字节) 拆分为三个通道, 每个通道 16 字节
+__attribute__((target("sse4.1")))
+inline void Deinterleave16(const uint8_t *src, __m128i *channels) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 32));
+
+    const __m128i a0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i b0 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+    const __m128i c0 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+    const __m128i a1 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i b1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+    const __m128i c1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+    const __m128i a2 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i b2 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+    const __m128i c2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+
+    channels[0] = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, a0), _mm_shuffle_epi8(b, b0)), _mm_shuffle_epi8(c, c0));
+    channels[1] = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, a1), _mm_shuffle_epi8(b, b1)), _mm_shuffle_epi8(c, c1));
+    channels[2] = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, a2), _mm_shuffle_epi8(b, b2)), _mm_shuffle_epi8(c, c2));
+}
+
+__attribute__((target("sse4.1")))
+void NormalizeRowSse41(const uint8_t *src, int width, const int *src_ch, const float *scale, const float *bias, float *const *dest) {
+    __m128 scales[3], biases[3];
+    for (int k = 0; k < 3; ++k) {
+        scales[k] = _mm_set1_ps(scale[k]);
+        biases[k] = _mm_set1_ps(bias[k]);
+    }
+
+    int x = 0;
+    __m128i channels[3];
+    for (; x + 16 <= width; x += 16) {
+        Deinterleave16(src + x * 3, channels);
+        for (int k = 0; k < 3; ++k) {
+            __m128i values = channels[src_ch[k]];
+            for (int i = 0; i < 4; ++i) {
+                __m128 v = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(values));
+                _mm_storeu_ps(dest[k] + x + i * 4, _mm_add_ps(_mm_mul_ps(v, scales[k]), biases[k]));
+                values = _mm_srli_si128(values, 4);
+            }
+        }
+    }
+
+    float *tail[3] = {dest[0] + x, dest[1] + x, dest[2] + x};
+    NormalizeRowScalar(src + x * 3, width - x, src_ch, scale, bias, tail);
+}
+
+__attribute__((target("sse4.1")))
+int ThresholdRowSse41(const float *src, int width, float threshold, uint8_t *dest, int &first, int &last) {
+    first = width;
+    last = -1;
+    int count = 0;
+    const __m128 thresholds = _mm_set1_ps(threshold);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i m0 = _mm_castps_si128(_mm_cmpgt_ps(_mm_loadu_ps(src + x), thresholds));
+        __m128i m1 = _mm_castps_si128(_mm_cmpgt_ps(_mm_loadu_ps(src + x + 4), thresholds));
+        __m128i m2 = _mm_castps_si128(_mm_cmpgt_ps(_mm_loadu_ps(src + x + 8), thresholds));
+        __m128i m3 = _mm_castps_si128(_mm_cmpgt_ps(_mm_loadu_ps(src + x + 12), thresholds));
+        // 比较结果为 -1 / 0, 饱和压缩后即为 0xFF / 0
+        __m128i bytes = _mm_packs_epi16(_mm_packs_epi32(m0, m1), _mm_packs_epi32(m2, m3));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + x), bytes);
+        count += AccumulateMask(_mm_movemask_epi8(bytes), x, first, last);
+    }
+    return count + ThresholdTail(src, x, width, threshold, dest, first, last);
+}
+
+__attribute__((target("avx2,fma")))
+void NormalizeRowAvx2(const uint8_t *src, int width, const int *src_ch, const float *scale, const float *bias, float *const *dest) {
+    __m256 scales[3], biases[3];
+    for (int k = 0; k < 3; ++k) {
+        scales[k] = _mm256_set1_ps(scale[k]);
+        biases[k] = _mm256_set1_ps(bias[k]);
+    }
+
+    int x = 0;
+    __m128i channels[3];
+    for (; x + 16 <= width; x += 16) {
+        Deinterleave16(src + x * 3, channels);
+        for (int k = 0; k < 3; ++k) {
+            __m128i values = channels[src_ch[k]];
+            __m256 low = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(values));
+            __m256 high = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(values, 8)));
+            _mm256_storeu_ps(dest[k] + x, _mm256_fmadd_ps(low, scales[k], biases[k]));
+            _mm256_storeu_ps(dest[k] + x + 8, _mm256_fmadd_ps(high, scales[k], biases[k]));
+        }
+    }
+
+    float *tail[3] = {dest[0] + x, dest[1] + x, dest[2] + x};
+    NormalizeRowScalar(src + x * 3, width - x, src_ch, scale, bias, tail);
+}
+
+__attribute__((target("avx2,fma")))
+int ThresholdRowAvx2(const float *src, int width, float threshold, uint8_t *dest, int &first, int &last) {
+    first = width;
+    last = -1;
+    int count = 0;
+    const __m256 thresholds = _mm256_set1_ps(threshold);
+    // 压缩在 128 位通道内进行, 需按 32 位重新排列
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m256i m0 = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(src + x), thresholds, _CMP_GT_OQ));
+        __m256i m1 = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(src + x + 8), thresholds, _CMP_GT_OQ));
+        __m256i m2 = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(src + x + 16), thresholds, _CMP_GT_OQ));
+        __m256i m3 = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(src + x + 24), thresholds, _CMP_GT_OQ));
+        __m256i bytes = _mm256_packs_epi16(_mm256_packs_epi32(m0, m1), _mm256_packs_epi32(m2, m3));
+        bytes = _mm256_permutevar8x32_epi32(bytes, order);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dest + x), bytes);
+        count += AccumulateMask(_mm256_movemask_epi8(bytes), x, first, last);
+    }
+    return count + ThresholdTail(src, x, width, threshold, dest, first, last);
+}
+
+__attribute__((target("avx512f")))
+void NormalizeRowAvx512(const uint8_t *src, int width, const int *src_ch, const float *scale, const float *bias, float *const *dest) {
+    __m512 scales[3], biases[3];
+    for (int k = 0; k < 3; ++k) {
+        scales[k] = _mm512_set1_ps(scale[k]);
+        biases[k] = _mm512_set1_ps(bias[k]);
+    }
+
+    int x = 0;
+    __m128i channels[3];
+    for (; x + 16 <= width; x += 16) {
+        Deinterleave16(src + x * 3, channels);
+        for (int k = 0; k < 3; ++k) {
+            __m512 v = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(channels[src_ch[k]]));
+            _mm512_storeu_ps(dest[k] + x, _mm512_fmadd_ps(v, scales[k], biases[k]));
+        }
+    }
+
+    float *tail[3] = {dest[0] + x, dest[1] + x, dest[2] + x};
+    NormalizeRowScalar(src + x * 3, width - x, src_ch, scale, bias, tail);
+}
+
+// Cephes 风格的 exp 近似, 相对误差约 1e-7
+const float kExpHi = 88.3762626647949f;
+const float kExpLo = -87.3365447504019f;
+const float kLog2e = 1.44269504088896341f;
+const float kLn2Hi = 0.693359375f;
+const float kLn2Lo = -2.12194440e-4f;
+const float kExpP0 = 1.9875691500e-4f;
+const float kExpP1 = 1.3981999507e-3f;
+const float kExpP2 = 8.3334519073e-3f;
+const float kExpP3 = 4.1665795894e-2f;
+const float kExpP4 = 1.6666665459e-1f;
+const float kExpP5 = 5.0000001201e-1f;
+
+__attribute__((target("avx2,fma")))
+inline __m256 Exp256(__m256 x) {
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(kExpLo)), _mm256_set1_ps(kExpHi));
+    // x = n * ln2 + r
+    __m256 n = _mm256_floor_ps(_mm256_fmadd_ps(x, _mm256_set1_ps(kLog2e), _mm256_set1_ps(0.5f)));
+    x = _mm256_fnmadd_ps(n, _mm256_set1_ps(kLn2Hi), x);
+    x = _mm256_fnmadd_ps(n, _mm256_set1_ps(kLn2Lo), x);
+
+    __m256 y = _mm256_set1_ps(kExpP0);
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP1));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP2));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP3));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP4));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP5));
+    y = _mm256_fmadd_ps(y, _mm256_mul_ps(x, x), _mm256_add_ps(x, _mm256_set1_ps(1.0f)));
+
+    // 2^n
+    __m256i exponent = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(exponent));
+}
+
+__attribute__((target("avx2,fma")))
+int ArgMaxAvx2(const float *data, int size, float &max_value) {
+    if (size < 16) return ArgMaxScalar(data, size, max_value);
+
+    // 先求最大值, 再找到第一个等于最大值的位置, 与标量实现的结果一致
+    __m256 max_vec = _mm256_loadu_ps(data);
+    int i = 8;
+    for (; i + 8 <= size; i += 8) {
+        max_vec = _mm256_max_ps(max_vec, _mm256_loadu_ps(data + i));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, max_vec);
+    max_value = lanes[0];
+    for (int k = 1; k < 8; ++k) {
+        max_value = std::max(max_value, lanes[k]);
+    }
+    for (; i < size; ++i) {
+        max_value = std::max(max_value, data[i]);
+    }
+
+    __m256 target = _mm256_set1_ps(max_value);
+    for (i = 0; i + 8 <= size; i += 8) {
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), target, _CMP_EQ_OQ));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    for (; i < size; ++i) {
+        if (data[i] == max_value) return i;
+    }
+    return 0;
+}
+
+__attribute__((target("avx2,fma")))
+float SumExpAvx2(const float *data, int size, float offset) {
+    __m256 sum = _mm256_setzero_ps();
+    __m256 offsets = _mm256_set1_ps(offset);
+    int i = 0;
+    for (; i + 8 <= size; i += 8) {
+        sum = _mm256_add_ps(sum, Exp256(_mm256_sub_ps(_mm256_loadu_ps(data + i), offsets)));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, sum);
+    float result = lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+    return result + SumExpScalar(data + i, size - i, offset);
+}
+
+__attribute__((target("avx512f")))
+inline __m512 Exp512(__m512 x) {
+    x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(kExpLo)), _mm512_set1_ps(kExpHi));
+    __m512 n = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(kLog2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    x = _mm512_fnmadd_ps(n, _mm512_set1_ps(kLn2Hi), x);
+    x = _mm512_fnmadd_ps(n, _mm512_set1_ps(kLn2Lo), x);
+
+    __m512 y = _mm512_set1_ps(kExpP0);
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP1));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP2));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP3));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP4));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP5));
+    y = _mm512_fmadd_ps(y, _mm512_mul_ps(x, x), _mm512_add_ps(x, _mm512_set1_ps(1.0f)));
+    return _mm512_scalef_ps(y, n);
+}
+
+__attribute__((target("avx512f")))
+int ArgMaxAvx512(const float *data, int size, float &max_value) {
+    if (size < 32) return ArgMaxScalar(data, size, max_value);
+
+    __m512 max_vec = _mm512_loadu_ps(data);
+    int i = 16;
+    for (; i + 16 <= size; i += 16) {
+        max_vec = _mm512_max_ps(max_vec, _mm512_loadu_ps(data + i));
+    }
+    max_value = _mm512_reduce_max_ps(max_vec);
+    for (; i < size; ++i) {
+        max_value = std::max(max_value, data[i]);
+    }
+
+    __m512 target = _mm512_set1_ps(max_value);
+    for (i = 0; i + 16 <= size; i += 16) {
+        __mmask16 mask = _mm512_cmp_ps_mask(_mm512_loadu_ps(data + i), target, _CMP_EQ_OQ);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    for (; i < size; ++i) {
+        if (data[i] == max_value) return i;
+    }
+    return 0;
+}
+
+__attribute__((target("avx512f")))
+int ThresholdRowAvx512(const float *src, int width, float threshold, uint8_t *dest, int &first, int &last) {
+    first = width;
+    last = -1;
+    int count = 0;
+    const __m512 thresholds = _mm512_set1_ps(threshold);
+    const __m512i ones = _mm512_set1_epi32(255);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __mmask16 mask = _mm512_cmp_ps_mask(_mm512_loadu_ps(src + x), thresholds, _CMP_GT_OQ);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + x), _mm512_cvtepi32_epi8(_mm512_maskz_mov_epi32(mask, ones)));
+        count += AccumulateMask(mask, x, first, last);
+    }
+    return count + ThresholdTail(src, x, width, threshold, dest, first, last);
+}
+
+__attribute__((target("avx512f")))
+float SumExpAvx512(const float *data, int size, float offset) {
+    __m512 sum = _mm512_setzero_ps();
+    __m512 offsets = _mm512_set1_ps(offset);
+    int i = 0;
+    for (; i + 16 <= size; i += 16) {
+        sum = _mm512_add_ps(sum, Exp512(_mm512_sub_ps(_mm512_loadu_ps(data + i), offsets)));
+    }
+    return _mm512_reduce_add_ps(sum) + SumExpScalar(data + i, size - i, offset);
+}
+
+#endif // OCR_SIMD_X86
+
+struct Dispatcher {
+    const char *isa_name;
+    NormalizeRowFunc normalize_row;
+    ArgMaxFunc arg_max;
+    SumExpFunc sum_exp;
+    ThresholdRowFunc threshold_row;
+
+    // SSE4.1 下 ArgMax / SumExp 仍使用标量实现
+    Dispatcher() : isa_name("scalar"), normalize_row(NormalizeRowScalar), arg_max(ArgMaxScalar), sum_exp(SumExpScalar), threshold_row(ThresholdRowScalar) {
+#ifdef OCR_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            isa_name = "avx512";
+            normalize_row = NormalizeRowAvx512;
+            arg_max = ArgMaxAvx512;
+            sum_exp = SumExpAvx512;
+            threshold_row = ThresholdRowAvx512;
+        } else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            isa_name = "avx2";
+            normalize_row = NormalizeRowAvx2;
+            arg_max = ArgMaxAvx2;
+            sum_exp = SumExpAvx2;
+            threshold_row = ThresholdRowAvx2;
+        } else if (__builtin_cpu_supports("sse4.1")) {
+            isa_name = "sse4.1";
+            normalize_row = NormalizeRowSse41;
+            threshold_row = ThresholdRowSse41;
+        }
+#endif
+    }
+};
+
+const Dispatcher &GetDispatcher() {
+    static const Dispatcher dispatcher;
+    return dispatcher;
+}
+
+} // namespace
+
+const char *SimdUtils::GetIsaName() {
+    return GetDispatcher().isa_name;
+}
+
+void SimdUtils::NormalizeRow(const uint8_t *src, int width, const int *src_ch, const float *scale, const float *bias, float *dest0, float *dest1, float *dest2) {
+    float *dest[3] = {dest0, dest1, dest2};
+    GetDispatcher().normalize_row(src, width, src_ch, scale, bias, dest);
+}
+
+int SimdUtils::ArgMax(const float *data, int size, float &max_value) {
+    return GetDispatcher().arg_max(data, size, max_value);
+}
+
+float SimdUtils::SumExp(const float *data, int size, float offset) {
+    return GetDispatcher().sum_exp(data, size, offset);
+}
+
+int SimdUtils::ThresholdRow(const float *src, int width, float threshold, uint8_t *dest, int &first, int &last) {
+    return GetDispatcher().threshold_row(src, width, threshold, dest, first, last);
+}
+
+} // namespace utils
@@ -0,0 +1,35 @@
+#include "utils/tensor_buffer.h"
+
+#include <algorithm>
+
+namespace utils {
+
+TensorBuffer::TensorBuffer()
+        : data_(),
+          shape_(),
+          size_(0),
+          memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)),
+          value_(nullptr) {}
+
+float *TensorBuffer::Reshape(std::initializer_list<int64_t> shape) {
+    size_t size = 1;
+    for (int64_t dim : shape) {
+        size *= static_cast<size_t>(dim);
+    }
+
+    bool is_same_shape = shape_.size() == shape.size() && std::equal(shape.begin(), shape.end(), shape_.begin());
+    if (is_same_shape && value_) {
+        return data_.data();
+    }
+
+    // 只增不减, 避免尺寸来回变化时反复分配
+    if (size > data_.size()) {
+        data_.resize(size);
+    }
+    shape_.assign(shape.begin(), shape.end());
+    size_ = size;
+    value_ = Ort::Value::CreateTensor<float>(memory_info_, data_.data(), size_, shape_.data(), shape_.size());
+    return data_.data();
+}
+
+} // namespace utils
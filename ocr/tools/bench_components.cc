@@ -0,0 +1,131 @@
+// 连通域与轮廓两种文本框提取方式的基准: 在合成的概率图上分别提取并计算得分, 输出耗时,
+// 按外接矩形对应两边的结果并比较得分; 数量或外接矩形对应不上时返回非 0
+// 用法: bench_components [width] [height] [blobs] [iterations]
+#include "utils/ocr_utils.h"
+#include "utils/simd_utils.h"
+
+#include <opencv4/opencv2/opencv.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+// 互不重叠的平行四边形文本行, 内部概率 0.5~1, 背景 0~0.1
+cv::Mat MakeProbabilityMap(int width, int height, int blobs, std::mt19937 &rng) {
+    std::uniform_real_distribution<float> background(0.0f, 0.1f), foreground(0.5f, 1.0f);
+    cv::Mat feat(height, width, CV_32FC1);
+    for (int y = 0; y < height; ++y) {
+        float *row = feat.ptr<float>(y);
+        for (int x = 0; x < width; ++x) {
+            row[x] = background(rng);
+        }
+    }
+
+    // 按网格放置, 保证各文本行之间至少隔一个像素
+    int cols = std::max(1, static_cast<int>(std::sqrt(blobs * 4.0)));
+    int rows = std::max(1, (blobs + cols - 1) / cols);
+    int cell_w = width / cols, cell_h = height / rows;
+    std::uniform_int_distribution<int> shear(-3, 3);
+    for (int i = 0; i < blobs; ++i) {
+        int left = (i % cols) * cell_w + 2, top = (i / cols) * cell_h + 2;
+        int w = std::max(4, cell_w - 12), h = std::max(3, cell_h - 12);
+        int slope = shear(rng);
+        for (int y = 0; y < h; ++y) {
+            float *row = feat.ptr<float>(top + y);
+            int shift = slope * y / h + 3;
+            for (int x = 0; x < w; ++x) {
+                row[left + shift + x] = foreground(rng);
+            }
+        }
+    }
+    return feat;
+}
+
+template <typename Func>
+double MeasureMs(int iterations, Func func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        func();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+struct Candidate {
+    cv::Rect rect;
+    float score;
+};
+
+bool RectLess(const Candidate &a, const Candidate &b) {
+    return a.rect.y != b.rect.y ? a.rect.y < b.rect.y : a.rect.x < b.rect.x;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int width = argc > 1 ? std::atoi(argv[1]) : 1280;
+    int height = argc > 2 ? std::atoi(argv[2]) : 1280;
+    int blobs = argc > 3 ? std::atoi(argv[3]) : 200;
+    int iterations = argc > 4 ? std::atoi(argv[4]) : 10;
+    const float threshold = 0.3f;
+
+    std::mt19937 rng(1);
+    cv::Mat feat = MakeProbabilityMap(width, height, blobs, rng);
+    cv::Mat binary(height, width, CV_8UC1);
+    std::vector<cv::Range> row_ranges(height);
+    for (int y = 0; y < height; ++y) {
+        int first, last;
+        int count = utils::SimdUtils::ThresholdRow(feat.ptr<float>(y), width, threshold, binary.ptr<uchar>(y), first, last);
+        row_ranges[y] = count > 0 ? cv::Range(first, last + 1) : cv::Range(0, 0);
+    }
+
+    // 两条路径都包含提取、得分与最小外接矩形, 与 DbNet::FindRsBoxes 中的工作量对应
+    std::vector<Candidate> contour_candidates, component_candidates;
+    double contour_ms = MeasureMs(iterations, [&]() {
+        std::vector<std::vector<cv::Point>> contours;
+        utils::OcrUtils::FindBandContours(binary, row_ranges, contours);
+        contour_candidates.clear();
+        for (const auto &contour : contours) {
+            float min_side_len, perimeter;
+            utils::OcrUtils::GetMinBoxes(contour, min_side_len, perimeter);
+            contour_candidates.push_back({cv::boundingRect(contour), utils::OcrUtils::BoxScoreFast(feat, contour)});
+        }
+    });
+    double component_ms = MeasureMs(iterations, [&]() {
+        std::vector<base::TextComponent> components;
+        utils::OcrUtils::FindComponents(binary, feat, components, &row_ranges);
+        component_candidates.clear();
+        for (const auto &component : components) {
+            float min_side_len, perimeter;
+            utils::OcrUtils::GetMinBoxes(component.points, min_side_len, perimeter);
+            component_candidates.push_back({component.rect, static_cast<float>(component.score_sum / component.span_area)});
+        }
+    });
+
+    printf("map: %dx%d, blobs: %d, iterations: %d\n", width, height, blobs, iterations);
+    printf("contour:   %8.3f ms, %zu boxes\n", contour_ms, contour_candidates.size());
+    printf("component: %8.3f ms, %zu boxes, speedup %.2fx\n", component_ms, component_candidates.size(), contour_ms / component_ms);
+
+    if (contour_candidates.size() != component_candidates.size()) {
+        printf("FAILED: box counts differ\n");
+        return 1;
+    }
+    std::sort(contour_candidates.begin(), contour_candidates.end(), RectLess);
+    std::sort(component_candidates.begin(), component_candidates.end(), RectLess);
+    double max_score_diff = 0.0;
+    for (size_t i = 0; i < contour_candidates.size(); ++i) {
+        if (contour_candidates[i].rect != component_candidates[i].rect) {
+            printf("FAILED: bounding rects differ at box %zu\n", i);
+            return 1;
+        }
+        max_score_diff = std::max(max_score_diff, static_cast<double>(std::fabs(contour_candidates[i].score - component_candidates[i].score)));
+    }
+    printf("max score diff: %.4f\n", max_score_diff);
+    return 0;
+}
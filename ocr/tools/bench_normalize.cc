@@ -0,0 +1,84 @@
+// 预处理的基准与一致性检查: 对比原先的 cvtColor(BGR->RGB) + cv::resize + 逐像素标量归一化, 与各网络实际调用的
+// OcrUtils::ResizeNormalize (cv::resize 后按 CPU 分派逐行交换通道并归一化), 输出两者的耗时与吞吐, 结果不一致时返回非 0
+// 用法: bench_normalize [src_width] [src_height] [dest_width] [dest_height] [iterations]
+#include "utils/ocr_utils.h"
+#include "utils/simd_utils.h"
+
+#include <opencv4/opencv2/opencv.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+// 原先的 SubstractMeanNormalize
+void ReferenceNormalize(const cv::Mat &image, const std::vector<float> &mean, const std::vector<float> &norm, float *dest) {
+    size_t num_channels = image.channels();
+    size_t image_size = image.cols * image.rows;
+    for (size_t pos = 0; pos < image_size; pos++) {
+        for (size_t ch = 0; ch < num_channels; ++ch) {
+            dest[ch * image_size + pos] = static_cast<float>((image.data[num_channels * pos + ch] - mean[ch]) * norm[ch]);
+        }
+    }
+}
+
+template <typename Func>
+double MeasureMs(int iterations, Func func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        func();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    // 默认取一张 3000x2000 的照片缩放到检测输入尺寸
+    int src_width = argc > 1 ? std::atoi(argv[1]) : 3000;
+    int src_height = argc > 2 ? std::atoi(argv[2]) : 2000;
+    int width = argc > 3 ? std::atoi(argv[3]) : 1120;
+    int height = argc > 4 ? std::atoi(argv[4]) : 736;
+    int iterations = argc > 5 ? std::atoi(argv[5]) : 20;
+
+    cv::Mat image(src_height, src_width, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+    const std::vector<float> mean{0.485 * 255, 0.456 * 255, 0.406 * 255};
+    const std::vector<float> norm{1.0 / 0.229 / 255.0, 1.0 / 0.224 / 255.0, 1.0 / 0.225 / 255.0};
+
+    size_t size = static_cast<size_t>(width) * height * 3;
+    std::vector<float> expected(size), actual(size);
+    cv::Mat rgb_image, resize_image;
+    double reference_ms = MeasureMs(iterations, [&]() {
+        cv::cvtColor(image, rgb_image, cv::COLOR_BGR2RGB);
+        cv::resize(rgb_image, resize_image, cv::Size(width, height));
+        ReferenceNormalize(resize_image, mean, norm, expected.data());
+    });
+    double fused_ms = MeasureMs(iterations, [&]() {
+        utils::OcrUtils::ResizeNormalize(image, width, height, width, mean, norm, true, cv::Scalar(), actual.data());
+    });
+
+    // 缩放逐通道进行, 与通道交换的先后无关; 向量实现以 FMA 计算 x * scale + bias, 与 (x - mean) * norm 只有舍入误差
+    double max_diff = 0.0;
+    for (size_t i = 0; i < size; ++i) {
+        max_diff = std::max(max_diff, static_cast<double>(std::fabs(expected[i] - actual[i])));
+    }
+
+    double megapixels = static_cast<double>(src_width) * src_height / 1e6;
+    printf("isa: %s, image: %dx%d -> %dx%d, iterations: %d\n", utils::SimdUtils::GetIsaName(), src_width, src_height, width, height, iterations);
+    printf("baseline: %8.3f ms  %8.1f MP/s\n", reference_ms, megapixels / reference_ms * 1e3);
+    printf("fused:    %8.3f ms  %8.1f MP/s  speedup %.2fx\n", fused_ms, megapixels / fused_ms * 1e3, reference_ms / fused_ms);
+    printf("max abs diff: %g\n", max_diff);
+
+    const double tolerance = 1e-4;
+    if (max_diff > tolerance) {
+        printf("FAILED: outputs differ by more than %g\n", tolerance);
+        return 1;
+    }
+    return 0;
+}
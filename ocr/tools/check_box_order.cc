@@ -0,0 +1,93 @@
+// 文本框输出顺序的一致性检查: 随机生成二值图, 对比
+//   1. FindBandContours 与整图 findContours (RETR_LIST) 的轮廓及其顺序;
+//   2. FindComponents 的连通域顺序与整图外轮廓逆序后的顺序 (DbNet 对轮廓逆序输出).
+// 任一不一致时返回非 0
+// 用法: check_box_order [count] [seed]
+#include "utils/ocr_utils.h"
+
+#include <opencv4/opencv2/opencv.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+// 随机放置互不接触的实心矩形, 连通域没有空洞, 与外轮廓一一对应; 另加稀疏噪点覆盖任意形状
+cv::Mat RandomBinary(std::mt19937 &rng, bool with_noise) {
+    std::uniform_int_distribution<int> size_dist(200, 600);
+    cv::Mat binary = cv::Mat::zeros(size_dist(rng), size_dist(rng), CV_8UC1);
+    std::uniform_int_distribution<int> count_dist(1, 60);
+    int count = count_dist(rng);
+    for (int k = 0; k < count; ++k) {
+        int w = 2 + rng() % 120, h = 2 + rng() % 24;
+        int x = rng() % std::max(1, binary.cols - w), y = rng() % std::max(1, binary.rows - h);
+        cv::Rect rect(x, y, w, h);
+        // 外扩 1 像素后仍不与已有前景相交, 保证 8 邻接下互不连通
+        cv::Rect guard = cv::Rect(x - 1, y - 1, w + 2, h + 2) & cv::Rect(0, 0, binary.cols, binary.rows);
+        if (cv::countNonZero(binary(guard)) > 0) continue;
+        binary(rect).setTo(255);
+    }
+    if (with_noise) {
+        for (int k = 0; k < binary.rows * binary.cols / 50; ++k) {
+            binary.at<uchar>(rng() % binary.rows, rng() % binary.cols) = 255;
+        }
+    }
+    return binary;
+}
+
+std::vector<cv::Range> GetRowRanges(const cv::Mat &binary) {
+    std::vector<cv::Range> row_ranges(binary.rows, cv::Range(0, 0));
+    for (int y = 0; y < binary.rows; ++y) {
+        const uchar *row = binary.ptr<uchar>(y);
+        int first = -1, last = -1;
+        for (int x = 0; x < binary.cols; ++x) {
+            if (!row[x]) continue;
+            if (first < 0) first = x;
+            last = x;
+        }
+        if (first >= 0) row_ranges[y] = cv::Range(first, last + 1);
+    }
+    return row_ranges;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 500;
+    unsigned seed = argc > 2 ? std::atoi(argv[2]) : 1;
+    std::mt19937 rng(seed);
+
+    int band_failed = 0, component_failed = 0;
+    for (int i = 0; i < count; ++i) {
+        // 轮廓: 含噪点的任意形状
+        cv::Mat binary = RandomBinary(rng, true);
+        std::vector<std::vector<cv::Point>> expected, contours;
+        cv::findContours(binary.clone(), expected, cv::RETR_LIST, cv::CHAIN_APPROX_SIMPLE);
+        utils::OcrUtils::FindBandContours(binary, GetRowRanges(binary), contours);
+        if (contours != expected) {
+            ++band_failed;
+        }
+
+        // 连通域: 无空洞的矩形, 外轮廓逆序后应与连通域顺序一一对应
+        binary = RandomBinary(rng, false);
+        cv::Mat feat(binary.size(), CV_32FC1, cv::Scalar(1.0f));
+        std::vector<std::vector<cv::Point>> outer;
+        cv::findContours(binary.clone(), outer, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+        std::reverse(outer.begin(), outer.end());
+        std::vector<base::TextComponent> components;
+        utils::OcrUtils::FindComponents(binary, feat, components);
+        bool same = components.size() == outer.size();
+        for (size_t k = 0; same && k < outer.size(); ++k) {
+            same = components[k].rect == cv::boundingRect(outer[k]);
+        }
+        if (!same) {
+            ++component_failed;
+        }
+    }
+
+    std::printf("maps %d band_contour_mismatch %d component_order_mismatch %d\n", count, band_failed, component_failed);
+    return band_failed == 0 && component_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+// 多数方向投票的检查: 原先取 indexes[most_index] 即第 0 或第 1 行的方向, 单行时越界读取, 且奇数行时以整除的一半为界.
+// 这里逐一核对典型输入的投票结果, 不一致时返回非 0
+// 用法: check_most_angle
+#include "utils/ocr_utils.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+std::vector<base::Angle> MakeAngles(const std::vector<int> &indexes) {
+    std::vector<base::Angle> angles;
+    for (int index : indexes) {
+        base::Angle angle = {};
+        angle.index = index;
+        angles.push_back(angle);
+    }
+    return angles;
+}
+
+} // namespace
+
+int main() {
+    struct Case {
+        std::vector<int> indexes;
+        int expected;
+    };
+    const std::vector<Case> cases = {
+        {{0}, 0},          // 单行倒置
+        {{1}, 1},          // 单行正向
+        {{1, 0, 0}, 0},    // 多数倒置, 与第 0、1 行无关
+        {{0, 1, 1}, 1},    // 多数正向
+        {{0, 0, 1}, 0},    // 奇数行, 原先以 3 / 2 = 1 为界判为正向
+        {{0, 1}, 1},       // 票数相同视为正向, 与原先一致
+        {{0, 0, 1, 1}, 1},
+        {{1, 0, 0, 0}, 0},
+    };
+
+    int failed = 0;
+    for (const Case &c : cases) {
+        int actual = utils::OcrUtils::GetMostAngleIndex(MakeAngles(c.indexes));
+        if (actual != c.expected) {
+            std::printf("FAILED: %zu lines, expected %d, got %d\n", c.indexes.size(), c.expected, actual);
+            ++failed;
+        }
+    }
+    std::printf("cases %zu failed %d\n", cases.size(), failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+// UnClipConvexQuad 与 Clipper 实现的一致性检查: 随机生成旋转矩形与一般凸四边形, 分别扩张后求最小外接矩形,
+// 两者的每个顶点与对方最近顶点在 x、y 方向的偏差均不超过 kTolerance 像素即视为一致; 同时输出两者的平均耗时
+// 用法: check_unclip [count] [seed]
+#include "utils/ocr_utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+// 两侧各自把扩张结果与最小外接矩形的顶点取整, Clipper 的圆角以折线近似, 极少数情况下累计偏差达到 3 像素
+const double kTolerance = 3.0;
+
+// 四个顶点之间的最大偏差, 顶点顺序在边长相等时可能不同, 按最近顶点比较
+double CornerDistance(const std::vector<cv::Point> &a, const std::vector<cv::Point> &b) {
+    double max_distance = 0.0;
+    for (const auto &p : a) {
+        double min_distance = 1e9;
+        for (const auto &q : b) {
+            min_distance = std::min(min_distance, static_cast<double>(std::max(std::abs(p.x - q.x), std::abs(p.y - q.y))));
+        }
+        max_distance = std::max(max_distance, min_distance);
+    }
+    return max_distance;
+}
+
+// 绕中心取四个递增的角度, 得到凸四边形; 旋转矩形也是其特例
+std::vector<cv::Point> RandomConvexQuad(std::mt19937 &rng) {
+    std::uniform_real_distribution<double> center(100.0, 900.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    double cx = center(rng), cy = center(rng);
+    std::vector<cv::Point> quad;
+    if (unit(rng) < 0.5) {
+        double w = 3 + unit(rng) * 300, h = 3 + unit(rng) * 60, angle = unit(rng) * M_PI;
+        for (int k = 0; k < 4; ++k) {
+            double sx = ((k == 1 || k == 2) ? w : -w) / 2, sy = (k >= 2 ? h : -h) / 2;
+            quad.emplace_back(cx + sx * std::cos(angle) - sy * std::sin(angle), cy + sx * std::sin(angle) + sy * std::cos(angle));
+        }
+    } else {
+        double start = unit(rng) * 2 * M_PI;
+        for (int k = 0; k < 4; ++k) {
+            double angle = start + (k + 0.2 + unit(rng) * 0.6) * M_PI / 2;
+            double radius = 10 + unit(rng) * 150;
+            quad.emplace_back(cx + radius * std::cos(angle), cy + radius * std::sin(angle));
+        }
+    }
+    return quad;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 5000;
+    unsigned seed = argc > 2 ? std::atoi(argv[2]) : 1;
+    std::mt19937 rng(seed);
+
+    int checked = 0, fallback = 0, failed = 0;
+    double max_distance = 0.0, quad_ms = 0.0, clipper_ms = 0.0;
+    for (int i = 0; i < count; ++i) {
+        std::vector<cv::Point> quad = RandomConvexQuad(rng);
+        float min_side_len, perimeter;
+        std::vector<cv::Point> box = utils::OcrUtils::GetMinBoxes(quad, min_side_len, perimeter);
+
+        std::vector<cv::Point> quad_box;
+        auto t0 = std::chrono::steady_clock::now();
+        bool ok = utils::OcrUtils::UnClipConvexQuad(box, perimeter, 2.0f, quad_box);
+        auto t1 = std::chrono::steady_clock::now();
+        std::vector<cv::Point> clipper_box = utils::OcrUtils::UnClipClipper(box, perimeter, 2.0f);
+        auto t2 = std::chrono::steady_clock::now();
+        quad_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        clipper_ms += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        if (!ok) {
+            // 退化的输入由 UnClip 交给 Clipper 处理, 不参与比较
+            ++fallback;
+            continue;
+        }
+
+        ++checked;
+        std::vector<cv::Point> quad_min_box = utils::OcrUtils::GetMinBoxes(quad_box, min_side_len, perimeter);
+        std::vector<cv::Point> clipper_min_box = utils::OcrUtils::GetMinBoxes(clipper_box, min_side_len, perimeter);
+        double distance = CornerDistance(quad_min_box, clipper_min_box);
+        max_distance = std::max(max_distance, distance);
+        if (distance > kTolerance) {
+            if (failed++ < 5) {
+                printf("mismatch %.2f px:", distance);
+                for (const auto &p : box) printf(" (%d,%d)", p.x, p.y);
+                printf("\n");
+            }
+        }
+    }
+
+    printf("checked: %d, fallback: %d, failed: %d, max corner diff: %.2f px (tolerance %.1f)\n", checked, fallback, failed, max_distance, kTolerance);
+    printf("quad: %.3f us, clipper: %.3f us per box\n", quad_ms / count * 1e3, clipper_ms / count * 1e3);
+    return failed == 0 ? 0 : 1;
+}
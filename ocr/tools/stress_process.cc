@@ -0,0 +1,90 @@
+// 并发压力测试: 多个线程共用一个 OcrLite 反复调用 Process, 结果需与单线程的结果一致.
+// 同时覆盖共享 Session 与 Session 池两种方式, 出现不一致或异常时返回非 0
+// 用法: stress_process <models_dir> <image_path> [threads] [iterations]
+#include "model/ocr_lite.h"
+#include "utils/file_utils.h"
+
+#include <opencv4/opencv2/opencv.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int kPadding = 50;
+const int kMaxSideLen = 1024;
+const float kBoxScoreThreshold = 0.6f;
+const float kBoxThreshold = 0.3f;
+const float kUnclipRatio = 2.0f;
+
+base::OcrResult ProcessOnce(model::OcrLite &ocr_lite, const cv::Mat &image) {
+    // Process 接收非 const 引用, 每次使用副本
+    cv::Mat src = image.clone();
+    return ocr_lite.Process(src, kPadding, kMaxSideLen, kBoxScoreThreshold, kBoxThreshold, kUnclipRatio, true, true);
+}
+
+// 返回不一致或出错的次数
+int RunStress(const std::string &models_dir, const cv::Mat &image, int sessions, int threads, int iterations) {
+    model::OcrLite ocr_lite;
+    ocr_lite.SetNumThreads(1);
+    ocr_lite.SetNumSessions(sessions, sessions, sessions);
+    ocr_lite.SetInputColorOrder(base::ColorOrder::kBgr);
+    ocr_lite.Init(utils::FileUtils::JoinPath(models_dir, "det.onnx"),
+                  utils::FileUtils::JoinPath(models_dir, "cls.onnx"),
+                  utils::FileUtils::JoinPath(models_dir, "rec.onnx"),
+                  utils::FileUtils::JoinPath(models_dir, "keys.txt"));
+
+    std::string expected = ProcessOnce(ocr_lite, image).str_result;
+
+    std::atomic<int> failures(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            for (int i = 0; i < iterations; ++i) {
+                try {
+                    if (ProcessOnce(ocr_lite, image).str_result != expected) {
+                        ++failures;
+                    }
+                } catch (const std::exception &e) {
+                    std::fprintf(stderr, "exception: %s\n", e.what());
+                    ++failures;
+                }
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    std::printf("sessions %d threads %d iterations %d failures %d\n", sessions, threads, iterations, failures.load());
+    return failures.load();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s <models_dir> <image_path> [threads] [iterations]\n", argv[0]);
+        return 2;
+    }
+    std::string models_dir = argv[1];
+    int threads = argc > 3 ? std::atoi(argv[3]) : 8;
+    int iterations = argc > 4 ? std::atoi(argv[4]) : 20;
+
+    cv::Mat image = cv::imread(argv[2], cv::IMREAD_COLOR);
+    if (image.empty()) {
+        std::fprintf(stderr, "failed to read image: %s\n", argv[2]);
+        return 2;
+    }
+
+    // 0: 所有线程共享一个 Session; 2: 少于线程数的 Session 池, 调用需排队借用
+    int failures = 0;
+    for (int sessions : {0, 2}) {
+        failures += RunStress(models_dir, image, sessions, threads, iterations);
+    }
+    return failures == 0 ? 0 : 1;
+}